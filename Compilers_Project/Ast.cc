@@ -0,0 +1,152 @@
+/*
+    Filename    : Ast.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Syntax Tree
+*/
+
+/***********************/
+// System includes
+
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "Ast.h"
+
+/***********************/
+
+const char* const AST_KIND_NAMES[AST_KIND_COUNT] =
+{
+    "program", "varDecl", "arrayDecl", "funDecl", "param", "arrayParam", "compound",
+    "exprStmt", "if", "while", "return", "assign", "binary", "var", "subscript", "call",
+    "num", "empty"
+};
+
+/***********************/
+
+Ast::Ast ()
+{
+}
+
+Ast::~Ast ()
+{
+}
+
+const std::vector<AstNode>&
+Ast::nodes () const
+{
+    return m_nodes;
+}
+
+const std::vector<uint32_t>&
+Ast::children () const
+{
+    return m_children;
+}
+
+uint32_t
+Ast::child (uint32_t node, uint32_t k) const
+{
+    return m_children[m_nodes[node].firstChild + k];
+}
+
+void
+Ast::clear ()
+{
+    m_nodes.clear ();
+    m_children.clear ();
+    m_stack.clear ();
+}
+
+void
+Ast::leaf (AstKind kind, int op, int token, int value)
+{
+    reduce (kind, op, token, 0, value);
+}
+
+void
+Ast::reduce (AstKind kind, int op, int token, int count, int value)
+{
+    AstNode node;
+    node.kind = kind;
+    node.op = op;
+    node.reserved = 0;
+    node.token = token;
+    node.value = value;
+    node.firstChild = m_children.size ();
+    node.childCount = count;
+    m_children.insert (m_children.end (), m_stack.end () - count, m_stack.end ());
+    m_stack.resize (m_stack.size () - count);
+    m_stack.push_back (m_nodes.size ());
+    m_nodes.push_back (node);
+}
+
+Ast::Mark
+Ast::mark () const
+{
+    return Mark { m_stack.size (), m_nodes.size (), m_children.size () };
+}
+
+int
+Ast::since (const Mark& m) const
+{
+    return m_stack.size () - m.stack;
+}
+
+void
+Ast::rewind (const Mark& m)
+{
+    m_stack.resize (m.stack);
+    m_nodes.resize (m.nodes);
+    m_children.resize (m.children);
+}
+
+// Nodes were created children first. A depth-first walk from the root
+// numbers them in preorder, then both arrays are rebuilt in that order.
+// The walk keeps its own stack, so deep trees are fine.
+void
+Ast::finish ()
+{
+    if (m_stack.size () != 1)
+    {
+        clear ();
+        return;
+    }
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> renumbered (m_nodes.size ());
+    order.reserve (m_nodes.size ());
+    std::vector<uint32_t> pending (1, m_stack.back ());
+    while (!pending.empty ())
+    {
+        uint32_t id = pending.back ();
+        pending.pop_back ();
+        renumbered[id] = order.size ();
+        order.push_back (id);
+        const AstNode& node = m_nodes[id];
+        for (uint32_t k = node.childCount; k > 0; --k)
+        {
+            pending.push_back (m_children[node.firstChild + k - 1]);
+        }
+    }
+
+    std::vector<AstNode> nodes;
+    std::vector<uint32_t> children;
+    nodes.reserve (order.size ());
+    children.reserve (order.size () - 1);
+    for (uint32_t id : order)
+    {
+        AstNode node = m_nodes[id];
+        uint32_t first = node.firstChild;
+        node.firstChild = children.size ();
+        for (uint32_t k = 0; k < node.childCount; ++k)
+        {
+            children.push_back (renumbered[m_children[first + k]]);
+        }
+        nodes.push_back (node);
+    }
+    m_nodes = std::move (nodes);
+    m_children = std::move (children);
+    m_stack.clear ();
+}
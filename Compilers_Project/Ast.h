@@ -0,0 +1,132 @@
+/*
+    Filename    : Ast.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Syntax Tree
+*/
+
+/***********************/
+
+#ifndef AST_H
+#define AST_H
+
+/***********************/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************/
+
+enum AstKind
+{
+    AST_PROGRAM,        // declarations
+    AST_VAR_DECL,       // op is the type; token the ID
+    AST_ARRAY_DECL,     // as AST_VAR_DECL; value is the length
+    AST_FUN_DECL,       // op is the return type; params, then the body
+    AST_PARAM,          // op is the type; token the ID
+    AST_ARRAY_PARAM,
+    AST_COMPOUND,       // local declarations, then statements
+    AST_EXPR_STMT,      // the expression, or nothing for ';'
+    AST_IF,             // condition, then, [else]
+    AST_WHILE,          // condition, body
+    AST_RETURN,         // [value]
+    AST_ASSIGN,         // target (AST_VAR or AST_SUBSCRIPT), value
+    AST_BINARY,         // op is the operator; left, right
+    AST_VAR,            // token is the ID
+    AST_SUBSCRIPT,      // token is the ID; index
+    AST_CALL,           // token is the ID; arguments
+    AST_NUM,            // value is the number
+    AST_EMPTY,          // a factor or stmt Parser accepted without matching
+                        // anything
+    AST_KIND_COUNT
+};
+
+extern const char* const AST_KIND_NAMES[AST_KIND_COUNT];
+
+// One node. token indexes the token stream the tree was parsed from (the
+// '{', 'if', operator or ID that the node starts at), and the node's
+// children are children[firstChild, firstChild + childCount). The same
+// layout is used on disk, see BinaryFormat.h.
+struct AstNode
+{
+    uint8_t  kind;
+    uint8_t  op;            // a TokenType, see AstKind
+    uint16_t reserved;
+    uint32_t token;
+    int32_t  value;
+    uint32_t firstChild;
+    uint32_t childCount;
+};
+
+static_assert (sizeof (AstNode) == 20, "AstNode is an on-disk record");
+
+/***********************/
+
+// A syntax tree as two flat arrays: the nodes in preorder, so node 0 is
+// the program and a node's subtree is the nodes that follow it, and the
+// child index lists all nodes share.
+//
+// Parser builds it bottom-up: leaf () and reduce () keep a stack of
+// finished subtrees, and finish () renumbers them into preorder. mark ()
+// and rewind () let the parser throw away what it built while trying an
+// alternative.
+class Ast
+{
+public:
+    struct Mark
+    {
+        size_t stack;
+        size_t nodes;
+        size_t children;
+    };
+
+    Ast ();
+
+    ~Ast ();
+
+    const std::vector<AstNode>&
+    nodes () const;
+
+    const std::vector<uint32_t>&
+    children () const;
+
+    // The k-th child of node
+    uint32_t
+    child (uint32_t node, uint32_t k) const;
+
+    void
+    clear ();
+
+    // Pushes a node with no children
+    void
+    leaf (AstKind kind, int op, int token, int value = 0);
+
+    // Pops the top count subtrees and pushes a node that owns them
+    void
+    reduce (AstKind kind, int op, int token, int count, int value = 0);
+
+    Mark
+    mark () const;
+
+    // Subtrees pushed since m
+    int
+    since (const Mark& m) const;
+
+    // Drops everything built since m
+    void
+    rewind (const Mark& m);
+
+    // Turns the single subtree left on the stack into the preorder arrays
+    void
+    finish ();
+
+private:
+    std::vector<AstNode> m_nodes;
+    std::vector<uint32_t> m_children;
+    std::vector<uint32_t> m_stack;
+};
+
+/***********************/
+
+#endif
@@ -0,0 +1,110 @@
+/*
+    Filename    : AstDump.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Syntax Tree
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+/***********************/
+// Local includes
+
+#include "BinaryFormat.h"
+
+/***********************/
+
+// Prints a file written by CMinus --emit=tokens|ast: the tree, indented,
+// or the tokens if there is no tree. Given the source file as well, it
+// shows each lexeme. Reads the file in place through BinaryView, as any
+// other tool would.
+//   usage: AstDump file.cmb [source.cm]
+
+/***********************/
+
+static std::string
+lexeme (const std::string& source, const BinaryToken& t)
+{
+    if (source.empty () || t.offset + t.length > source.size ())
+    {
+        return "@" + std::to_string (t.offset);
+    }
+    return source.substr (t.offset, t.length);
+}
+
+int
+main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s file.cmb [source.cm]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    BinaryView view (argv[1]);
+    if (!view.valid ())
+    {
+        fprintf (stderr, "%s: not a CMinus binary file of this version\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    std::string source;
+    if (argc > 2)
+    {
+        FILE* srcFile = fopen (argv[2], "rb");
+        if (srcFile == NULL)
+        {
+            perror (argv[2]);
+            return EXIT_FAILURE;
+        }
+        char buffer[1 << 16];
+        size_t n;
+        while ((n = fread (buffer, 1, sizeof (buffer), srcFile)) > 0)
+        {
+            source.append (buffer, n);
+        }
+        fclose (srcFile);
+    }
+
+    printf ("%u tokens, %u nodes\n", view.tokenCount (), view.nodeCount ());
+    if (!view.hasAst ())
+    {
+        for (uint32_t i = 0; i < view.tokenCount (); ++i)
+        {
+            BinaryToken t = view.token (i);
+            printf ("%6u  type %2d  offset %8u  %s\n", i, t.type, t.offset,
+                    lexeme (source, t).c_str ());
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // Node and depth, walked in preorder
+    std::vector<std::pair<uint32_t, int>> pending (1, std::make_pair (0u, 0));
+    while (!pending.empty ())
+    {
+        uint32_t id = pending.back ().first;
+        int depth = pending.back ().second;
+        pending.pop_back ();
+        const AstNode& node = view.node (id);
+        // Indentation stops growing past 32 levels, as in CorpusGen
+        printf ("%*s%s %s", std::min (depth, 32) * 2, "", AST_KIND_NAMES[node.kind],
+                lexeme (source, view.token (node.token)).c_str ());
+        if (node.kind == AST_ARRAY_DECL || node.kind == AST_NUM)
+        {
+            printf (" [%d]", node.value);
+        }
+        printf ("\n");
+        const uint32_t* children = view.children (id);
+        for (uint32_t k = node.childCount; k > 0; --k)
+        {
+            pending.push_back (std::make_pair (children[k - 1], depth + 1));
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+/*
+    Filename    : BenchClock.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Benchmarks
+*/
+
+/***********************/
+
+#ifndef BENCH_CLOCK_H
+#define BENCH_CLOCK_H
+
+/***********************/
+
+#include <chrono>
+
+/***********************/
+
+// Seconds since begin, which the benchmarks take from steady_clock::now ()
+inline double
+seconds (std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ();
+}
+
+/***********************/
+
+#endif
@@ -0,0 +1,306 @@
+/*
+    Filename    : BinaryFormat.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Syntax Tree
+*/
+
+/***********************/
+// System includes
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/***********************/
+// Local includes
+
+#include "BinaryFormat.h"
+
+/***********************/
+
+static const char MAGIC[8] = { 'C', 'M', 'B', 'I', 'N', 'A', 'R', 'Y' };
+static const uint32_t VERSION = 1;
+
+// Tokens between checkpoints
+static const uint32_t CHECKPOINT = 64;
+
+struct Header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t tokenCount;
+    uint32_t checkpointCount;
+    uint32_t nodeCount;     // 0 without a tree
+    uint32_t childCount;
+    uint32_t reserved;
+    uint64_t tokenBytes;
+    uint64_t checkpointsAt; // file offsets of the sections
+    uint64_t tokensAt;
+    uint64_t nodesAt;
+    uint64_t childrenAt;
+};
+
+/***********************/
+
+static void
+putVarint (std::string& out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out += (char) (value | 0x80);
+        value >>= 7;
+    }
+    out += (char) value;
+}
+
+static uint32_t
+getVarint (const uint8_t*& p, const uint8_t* end)
+{
+    uint32_t value = 0;
+    for (int shift = 0; p < end && shift < 35; shift += 7)
+    {
+        uint8_t byte = *p++;
+        value |= (uint32_t) (byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            break;
+        }
+    }
+    return value;
+}
+
+static uint64_t
+align8 (uint64_t n)
+{
+    return (n + 7) & ~(uint64_t) 7;
+}
+
+/***********************/
+
+bool
+writeBinary (FILE* out, const std::vector<Token>& tokens, const Ast* ast)
+{
+    std::string stream;
+    std::vector<uint32_t> checkpoints;
+    stream.reserve (tokens.size () * 3);
+    checkpoints.reserve (tokens.size () / CHECKPOINT + 1);
+    uint32_t previous = 0;
+    for (size_t i = 0; i < tokens.size (); ++i)
+    {
+        const Token& t = tokens[i];
+        if (i % CHECKPOINT == 0)
+        {
+            checkpoints.push_back (stream.size ());
+            previous = 0;
+        }
+        // Offsets only grow, but unsigned wraparound decodes either way
+        putVarint (stream, t.type);
+        putVarint (stream, (uint32_t) t.offset - previous);
+        putVarint (stream, t.lexeme.size ());
+        previous = t.offset;
+    }
+
+    Header header;
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, MAGIC, sizeof (MAGIC));
+    header.version = VERSION;
+    header.tokenCount = tokens.size ();
+    header.checkpointCount = checkpoints.size ();
+    header.nodeCount = ast != NULL ? ast->nodes ().size () : 0;
+    header.childCount = ast != NULL ? ast->children ().size () : 0;
+    header.tokenBytes = stream.size ();
+    header.checkpointsAt = sizeof (Header);
+    header.tokensAt = align8 (header.checkpointsAt + checkpoints.size () * sizeof (uint32_t));
+    header.nodesAt = align8 (header.tokensAt + stream.size ());
+    header.childrenAt = align8 (header.nodesAt + header.nodeCount * sizeof (AstNode));
+
+    static const char ZEROS[8] = { 0 };
+    uint64_t at = 0;
+    bool written = true;
+    auto put = [&] (uint64_t sectionAt, const void* data, size_t bytes) {
+        written = written && fwrite (ZEROS, 1, sectionAt - at, out) == sectionAt - at &&
+                  fwrite (data, 1, bytes, out) == bytes;
+        at = sectionAt + bytes;
+    };
+    put (0, &header, sizeof (header));
+    put (header.checkpointsAt, checkpoints.data (), checkpoints.size () * sizeof (uint32_t));
+    put (header.tokensAt, stream.data (), stream.size ());
+    if (ast != NULL)
+    {
+        put (header.nodesAt, ast->nodes ().data (), header.nodeCount * sizeof (AstNode));
+        put (header.childrenAt, ast->children ().data (), header.childCount * sizeof (uint32_t));
+    }
+    return fflush (out) == 0 && written;
+}
+
+/***********************/
+
+// True if count records of size bytes starting at offset at end by limit,
+// without overflowing
+static bool
+fits (uint64_t at, uint64_t count, uint64_t size, uint64_t limit)
+{
+    return at % 8 == 0 && at <= limit && count <= (limit - at) / size;
+}
+
+// Checks everything a reader relies on, so a damaged or hostile file is
+// rejected rather than read out of bounds: the sections are in order and
+// inside the file, every checkpoint is inside the token stream, and the
+// nodes form a tree in which each node is the child of exactly one node
+// before it and names a token that exists
+static bool
+consistent (const char* map, uint64_t mapSize)
+{
+    const Header* h = (const Header*) map;
+    if (memcmp (h->magic, MAGIC, sizeof (MAGIC)) != 0 || h->version != VERSION ||
+        h->checkpointCount != (h->tokenCount + CHECKPOINT - 1) / CHECKPOINT ||
+        h->checkpointsAt < sizeof (Header) ||
+        !fits (h->checkpointsAt, h->checkpointCount, sizeof (uint32_t), h->tokensAt) ||
+        !fits (h->tokensAt, h->tokenBytes, 1, mapSize))
+    {
+        return false;
+    }
+    const uint32_t* checkpoints = (const uint32_t*) (map + h->checkpointsAt);
+    for (uint32_t i = 0; i < h->checkpointCount; ++i)
+    {
+        if (checkpoints[i] > h->tokenBytes)
+        {
+            return false;
+        }
+    }
+    if (h->nodeCount == 0)
+    {
+        return true;
+    }
+    if (h->nodesAt < h->tokensAt + h->tokenBytes ||
+        !fits (h->nodesAt, h->nodeCount, sizeof (AstNode), h->childrenAt) ||
+        !fits (h->childrenAt, h->childCount, sizeof (uint32_t), mapSize))
+    {
+        return false;
+    }
+    const AstNode* nodes = (const AstNode*) (map + h->nodesAt);
+    const uint32_t* children = (const uint32_t*) (map + h->childrenAt);
+    std::vector<bool> parented (h->nodeCount, false);
+    for (uint32_t id = 0; id < h->nodeCount; ++id)
+    {
+        const AstNode& n = nodes[id];
+        if (n.kind >= AST_KIND_COUNT || n.token >= h->tokenCount ||
+            n.firstChild > h->childCount || n.childCount > h->childCount - n.firstChild)
+        {
+            return false;
+        }
+        for (uint32_t k = 0; k < n.childCount; ++k)
+        {
+            uint32_t c = children[n.firstChild + k];
+            if (c <= id || c >= h->nodeCount || parented[c])
+            {
+                return false;
+            }
+            parented[c] = true;
+        }
+    }
+    return true;
+}
+
+/***********************/
+
+BinaryView::BinaryView (const std::string& path)
+    : m_map (NULL), m_mapSize (0), m_checkpoints (NULL), m_tokens (NULL), m_nodes (NULL),
+      m_children (NULL)
+{
+    int fd = open (path.c_str (), O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat info;
+    if (fstat (fd, &info) != 0 || (size_t) info.st_size < sizeof (Header))
+    {
+        close (fd);
+        return;
+    }
+    void* map = mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED)
+    {
+        return;
+    }
+    m_map = (const char*) map;
+    m_mapSize = info.st_size;
+
+    const Header* h = (const Header*) m_map;
+    if (!consistent (m_map, m_mapSize))
+    {
+        munmap ((void*) m_map, m_mapSize);
+        m_map = NULL;
+        m_mapSize = 0;
+        return;
+    }
+    m_checkpoints = (const uint32_t*) (m_map + h->checkpointsAt);
+    m_tokens = (const uint8_t*) (m_map + h->tokensAt);
+    m_nodes = (const AstNode*) (m_map + h->nodesAt);
+    m_children = (const uint32_t*) (m_map + h->childrenAt);
+}
+
+BinaryView::~BinaryView ()
+{
+    if (m_map != NULL)
+    {
+        munmap ((void*) m_map, m_mapSize);
+    }
+}
+
+bool
+BinaryView::valid ()
+{
+    return m_map != NULL;
+}
+
+bool
+BinaryView::hasAst ()
+{
+    return ((const Header*) m_map)->nodeCount > 0;
+}
+
+uint32_t
+BinaryView::tokenCount ()
+{
+    return ((const Header*) m_map)->tokenCount;
+}
+
+// Decodes forward from the checkpoint before index
+BinaryToken
+BinaryView::token (uint32_t index)
+{
+    const uint8_t* end = m_tokens + ((const Header*) m_map)->tokenBytes;
+    const uint8_t* p = m_tokens + m_checkpoints[index / CHECKPOINT];
+    BinaryToken t = { END_OF_FILE, 0, 0 };
+    for (uint32_t i = index - index % CHECKPOINT; i <= index; ++i)
+    {
+        t.type = (TokenType) getVarint (p, end);
+        t.offset += getVarint (p, end);
+        t.length = getVarint (p, end);
+    }
+    return t;
+}
+
+uint32_t
+BinaryView::nodeCount ()
+{
+    return ((const Header*) m_map)->nodeCount;
+}
+
+const AstNode&
+BinaryView::node (uint32_t index)
+{
+    return m_nodes[index];
+}
+
+const uint32_t*
+BinaryView::children (uint32_t index)
+{
+    return m_children + m_nodes[index].firstChild;
+}
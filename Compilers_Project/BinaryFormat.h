@@ -0,0 +1,102 @@
+/*
+    Filename    : BinaryFormat.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Syntax Tree
+*/
+
+/***********************/
+
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+/***********************/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Ast.h"
+#include "Lexer.h"
+
+/***********************/
+
+// What CMinus --emit=tokens|ast writes, for other tools to read without
+// scraping its text output. A file is
+//
+//   Header             fixed size, see BinaryFormat.cc
+//   uint32[c]          checkpoints: byte position of every 64th token
+//                      in the token stream
+//   token stream       per token: type, offset, lexeme length, as
+//                      LEB128 varints
+//   AstNode[n]         the syntax tree in preorder (--emit=ast only)
+//   uint32[m]          the nodes' child index lists
+//
+// A token's offset is stored as the difference from the previous token's,
+// except at a checkpoint, where it is absolute; so any token can be found
+// by decoding at most 63 others. Lexemes are the source bytes at their
+// offsets and are not stored. Sections start on 8-byte boundaries and
+// every integer is little-endian, so a reader can use the file straight
+// from an mmap. The header has a format version; readers reject others.
+
+/***********************/
+
+// Writes tokens, and the tree too if ast is not NULL; false on an I/O error
+bool
+writeBinary (FILE* out, const std::vector<Token>& tokens, const Ast* ast);
+
+// A token as stored
+struct BinaryToken
+{
+    TokenType type;
+    uint32_t offset;
+    uint32_t length;
+};
+
+// Reads a file written by writeBinary in place
+class BinaryView
+{
+public:
+    // Maps the file; check valid () before using the view
+    BinaryView (const std::string& path);
+
+    ~BinaryView ();
+
+    // The file exists, has this version's layout and is consistent, so
+    // every index the view hands out is in bounds
+    bool
+    valid ();
+
+    bool
+    hasAst ();
+
+    uint32_t
+    tokenCount ();
+
+    BinaryToken
+    token (uint32_t index);
+
+    uint32_t
+    nodeCount ();
+
+    const AstNode&
+    node (uint32_t index);
+
+    // The child index list of node index
+    const uint32_t*
+    children (uint32_t index);
+
+private:
+    const char* m_map;
+    size_t m_mapSize;
+    const uint32_t* m_checkpoints;
+    const uint8_t* m_tokens;
+    const AstNode* m_nodes;
+    const uint32_t* m_children;
+};
+
+/***********************/
+
+#endif
@@ -0,0 +1,895 @@
+/*
+    Filename    : BoundsCheck.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Bounds-Check Elimination
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <iterator>
+#include <unordered_map>
+
+/***********************/
+// Local includes
+
+#include "BoundsCheck.h"
+#include "SymbolTable.h"
+
+/***********************/
+
+namespace
+{
+    // Bounds at or past INF are unbounded, and arithmetic on them stays so
+    const int64_t INF = INT64_MAX / 4;
+
+    struct Range
+    {
+        int64_t lo;
+        int64_t hi;
+    };
+
+    const Range UNKNOWN = { -INF, INF };
+
+    int64_t
+    clamp (int64_t v)
+    {
+        return std::max (-INF, std::min (INF, v));
+    }
+
+    int64_t
+    addBound (int64_t a, int64_t b)
+    {
+        if (a <= -INF || b <= -INF)
+        {
+            return -INF;
+        }
+        if (a >= INF || b >= INF)
+        {
+            return INF;
+        }
+        return clamp (a + b);
+    }
+
+    // Unbounded ends of an int stand for INT32_MIN and INT32_MAX
+    Range
+    finite (Range r)
+    {
+        return Range { std::max<int64_t> (r.lo, INT32_MIN), std::min<int64_t> (r.hi, INT32_MAX) };
+    }
+
+    // C-Minus ints wrap at 32 bits, so a result that may leave int could
+    // be anything
+    Range
+    wrapped (int64_t lo, int64_t hi)
+    {
+        return lo < INT32_MIN || hi > INT32_MAX ? UNKNOWN : Range { lo, hi };
+    }
+
+    // Ranges of the scalar locals known at one point, keyed by declaring
+    // token. shift is how much the innermost loop's induction variable
+    // has grown since the loop test, INF if that is unknown.
+    struct Env
+    {
+        std::map<uint32_t, Range> ranges;
+        int64_t shift;
+        bool dead;          // after a return
+    };
+
+    Env
+    join (const Env& a, const Env& b)
+    {
+        if (a.dead)
+        {
+            return b;
+        }
+        if (b.dead)
+        {
+            return a;
+        }
+        Env e = { {}, std::max (a.shift, b.shift), false };
+        for (const std::pair<const uint32_t, Range>& r : a.ranges)
+        {
+            std::map<uint32_t, Range>::const_iterator other = b.ranges.find (r.first);
+            if (other != b.ranges.end ())
+            {
+                e.ranges[r.first] = Range { std::min (r.second.lo, other->second.lo),
+                                            std::max (r.second.hi, other->second.hi) };
+            }
+        }
+        return e;
+    }
+
+    // A while loop is the preorder node range [begin, end)
+    struct Loop
+    {
+        uint32_t begin;
+        uint32_t end;
+        bool hasCall;
+        int iv;             // declaring token, or -1
+    };
+
+    // True if some node in positions, which is sorted, falls in loop
+    bool
+    within (const std::vector<uint32_t>& positions, const Loop& loop)
+    {
+        std::vector<uint32_t>::const_iterator p =
+            std::lower_bound (positions.begin (), positions.end (), loop.begin);
+        return p != positions.end () && *p < loop.end;
+    }
+
+    // The constant c if id is 'var + c', 'c + var' or 'var - c'
+    bool
+    offsetOf (const Ast& ast, const SymbolTable& symbols, uint32_t id, int var, int64_t& c)
+    {
+        const AstNode& n = ast.nodes ()[id];
+        if (n.kind == AST_VAR)
+        {
+            c = 0;
+            return symbols.definition (n.token) == var;
+        }
+        if (n.kind != AST_BINARY || (n.op != PLUS && n.op != MINUS))
+        {
+            return false;
+        }
+        const AstNode& a = ast.nodes ()[ast.child (id, 0)];
+        const AstNode& b = ast.nodes ()[ast.child (id, 1)];
+        if (a.kind == AST_VAR && b.kind == AST_NUM && symbols.definition (a.token) == var)
+        {
+            c = n.op == PLUS ? b.value : -(int64_t) b.value;
+            return true;
+        }
+        if (n.op == PLUS && a.kind == AST_NUM && b.kind == AST_VAR && symbols.definition (b.token) == var)
+        {
+            c = a.value;
+            return true;
+        }
+        return false;
+    }
+
+    // What the walk over each function looks up, built once for the
+    // program so the functions can be walked independently
+    struct Index
+    {
+        Index (const Ast& ast, const std::vector<Token>& tokens);
+
+        const Ast& ast;
+        SymbolTable symbols;
+        std::vector<int32_t> lengths;       // by declaring token; -1 if unknown
+        std::vector<bool> local;            // scalar local or parameter
+        std::vector<uint32_t> end;          // end of each node's subtree
+        std::vector<uint32_t> callsBefore;  // calls among nodes [0, id)
+        std::vector<uint32_t> loopOf;       // innermost AST_WHILE around id, or UINT32_MAX
+        std::unordered_map<int, std::vector<uint32_t>> assignments;
+        std::unordered_map<int, std::vector<uint32_t>> otherAssignments;  // not 'x = x + c', c > 0
+        std::vector<uint32_t> functions;
+    };
+
+    // Indexes where each variable is assigned and where the calls are, so
+    // what a loop changes is a lookup rather than a walk over it
+    Index::Index (const Ast& ast, const std::vector<Token>& tokens)
+        : ast (ast), symbols (tokens), lengths (tokens.size (), -1), local (tokens.size (), false)
+    {
+        const std::vector<AstNode>& nodes = ast.nodes ();
+        end.resize (nodes.size ());
+        for (uint32_t id = nodes.size (); id-- > 0; )
+        {
+            end[id] = id + 1;
+            if (nodes[id].childCount > 0)
+            {
+                end[id] = end[ast.child (id, nodes[id].childCount - 1)];
+            }
+        }
+        callsBefore.resize (nodes.size () + 1, 0);
+        loopOf.resize (nodes.size ());
+        std::vector<uint32_t> loops;
+        for (uint32_t id = 0; id < nodes.size (); ++id)
+        {
+            while (!loops.empty () && end[loops.back ()] <= id)
+            {
+                loops.pop_back ();
+            }
+            loopOf[id] = loops.empty () ? UINT32_MAX : loops.back ();
+            if (nodes[id].kind == AST_WHILE)
+            {
+                loops.push_back (id);
+            }
+            callsBefore[id + 1] = callsBefore[id] + (nodes[id].kind == AST_CALL);
+            if (nodes[id].kind == AST_ASSIGN && nodes[ast.child (id, 0)].kind == AST_VAR)
+            {
+                int d = symbols.definition (nodes[ast.child (id, 0)].token);
+                int64_t c;
+                assignments[d].push_back (id);
+                if (!offsetOf (ast, symbols, ast.child (id, 1), d, c) || c <= 0)
+                {
+                    otherAssignments[d].push_back (id);
+                }
+            }
+        }
+
+        const AstNode& program = nodes[0];
+        for (uint32_t k = 0; k < program.childCount; ++k)
+        {
+            uint32_t child = ast.child (0, k);
+            if (nodes[child].kind == AST_ARRAY_DECL)
+            {
+                lengths[nodes[child].token] = nodes[child].value;
+                continue;
+            }
+            if (nodes[child].kind != AST_FUN_DECL)
+            {
+                continue;
+            }
+            functions.push_back (child);
+            for (uint32_t id = child + 1; id < end[child]; ++id)
+            {
+                const AstNode& n = nodes[id];
+                if (n.kind == AST_VAR_DECL || n.kind == AST_PARAM ||
+                    n.kind == AST_ARRAY_DECL || n.kind == AST_ARRAY_PARAM)
+                {
+                    local[n.token] = n.kind == AST_VAR_DECL || n.kind == AST_PARAM;
+                    lengths[n.token] = n.kind == AST_ARRAY_DECL ? n.value : -1;
+                }
+            }
+        }
+    }
+
+    class Walker
+    {
+    public:
+        Walker (const Index& index, std::vector<BoundsCheck>& checks)
+            : m_ast (index.ast), m_symbols (index.symbols), m_lengths (index.lengths),
+              m_local (index.local), m_checks (checks), m_end (index.end),
+              m_callsBefore (index.callsBefore), m_loopOf (index.loopOf),
+              m_assignments (index.assignments),
+              m_otherAssignments (index.otherAssignments), m_function (0)
+        {
+        }
+
+        void
+        function (uint32_t id)
+        {
+            m_function = id;
+            m_loops.clear ();
+            Env env = { {}, INF, false };
+            const AstNode& f = node (id);
+            for (uint32_t k = 0; k < f.childCount; ++k)
+            {
+                uint32_t c = child (id, k);
+                if (node (c).kind == AST_COMPOUND)
+                {
+                    stmt (c, env);
+                }
+                else
+                {
+                    declare (node (c), env);
+                }
+            }
+        }
+
+    private:
+        const AstNode&
+        node (uint32_t id)
+        {
+            return m_ast.nodes ()[id];
+        }
+
+        uint32_t
+        child (uint32_t id, uint32_t k)
+        {
+            return m_ast.child (id, k);
+        }
+
+        int
+        declaration (uint32_t token)
+        {
+            return m_symbols.definition (token);
+        }
+
+        void
+        declare (const AstNode& n, Env& env)
+        {
+            env.ranges.erase (n.token);
+        }
+
+        // The range of a number or variable
+        Range
+        operand (const AstNode& n, const Env& env)
+        {
+            if (n.kind == AST_NUM)
+            {
+                return Range { n.value, n.value };
+            }
+            int d = n.kind == AST_VAR ? declaration (n.token) : -1;
+            std::map<uint32_t, Range>::const_iterator r = env.ranges.find (d);
+            return d >= 0 && r != env.ranges.end () ? r->second : UNKNOWN;
+        }
+
+        Range
+        arithmetic (uint8_t op, Range a, Range b)
+        {
+            a = finite (a);
+            b = finite (b);
+            switch (op)
+            {
+                case PLUS:
+                    return wrapped (a.lo + b.lo, a.hi + b.hi);
+                case MINUS:
+                    return wrapped (a.lo - b.hi, a.hi - b.lo);
+                case TIMES:
+                {
+                    int64_t p[] = { a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi };
+                    return wrapped (*std::min_element (p, p + 4), *std::max_element (p, p + 4));
+                }
+                case DIVIDE:
+                    return UNKNOWN;
+                default:
+                    return Range { 0, 1 };
+            }
+        }
+
+        // A binary expression comes back off the stack once both operands
+        // are on the value stack
+        Range
+        interval (uint32_t id, const Env& env)
+        {
+            if (node (id).kind != AST_BINARY && node (id).kind != AST_ASSIGN)
+            {
+                return operand (node (id), env);
+            }
+            std::vector<std::pair<uint32_t, bool>> pending (1, std::make_pair (id, false));
+            std::vector<Range> values;
+            while (!pending.empty ())
+            {
+                uint32_t next = pending.back ().first;
+                bool operandsDone = pending.back ().second;
+                pending.pop_back ();
+                const AstNode& n = node (next);
+                if (n.kind == AST_ASSIGN)
+                {
+                    pending.push_back (std::make_pair (child (next, 1), false));
+                }
+                else if (n.kind == AST_BINARY && !operandsDone)
+                {
+                    pending.push_back (std::make_pair (next, true));
+                    pending.push_back (std::make_pair (child (next, 1), false));
+                    pending.push_back (std::make_pair (child (next, 0), false));
+                }
+                else if (n.kind == AST_BINARY)
+                {
+                    Range b = values.back ();
+                    values.pop_back ();
+                    values.back () = arithmetic (n.op, values.back (), b);
+                }
+                else
+                {
+                    values.push_back (operand (n, env));
+                }
+            }
+            return values.back ();
+        }
+
+        bool
+        offsetOf (uint32_t id, int var, int64_t& c)
+        {
+            return ::offsetOf (m_ast, m_symbols, id, var, c);
+        }
+
+        // True if evaluating id assigns a variable. The ranges refine sees
+        // are those after cond ran, so a comparison against a value cond
+        // then overwrote says nothing about the variable.
+        bool
+        assigns (uint32_t id)
+        {
+            for (uint32_t next = id; next < m_end[id]; ++next)
+            {
+                if (node (next).kind == AST_ASSIGN)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Narrows the range of a local compared against in cond, on the
+        // path where cond is (taken) or is not true, unless cond assigns
+        void
+        refine (uint32_t cond, Env& env, bool taken)
+        {
+            const AstNode& c = node (cond);
+            if (c.kind != AST_BINARY || c.op < LT || c.op > NEQ || assigns (cond))
+            {
+                return;
+            }
+            static const TokenType NEGATED[] = { GTE, GT, LTE, LT, NEQ, EQ };
+            static const TokenType SWAPPED[] = { GT, GTE, LT, LTE, EQ, NEQ };
+            TokenType op = (TokenType) c.op;
+            uint32_t var = child (cond, 0);
+            uint32_t other = child (cond, 1);
+            if (node (var).kind != AST_VAR)
+            {
+                std::swap (var, other);
+                op = SWAPPED[op - LT];
+            }
+            int d = node (var).kind == AST_VAR ? declaration (node (var).token) : -1;
+            if (d < 0 || !m_local[d])
+            {
+                return;
+            }
+            if (!taken)
+            {
+                op = NEGATED[op - LT];
+            }
+            Range r = interval (other, env);
+            Range x = interval (var, env);
+            switch (op)
+            {
+                case LT:  x.hi = std::min (x.hi, addBound (r.hi, -1)); break;
+                case LTE: x.hi = std::min (x.hi, r.hi); break;
+                case GT:  x.lo = std::max (x.lo, addBound (r.lo, 1)); break;
+                case GTE: x.lo = std::max (x.lo, r.lo); break;
+                case EQ:  x = Range { std::max (x.lo, r.lo), std::min (x.hi, r.hi) }; break;
+                default:  return;
+            }
+            // An empty range means the path looks impossible; that is too
+            // strong a claim to eliminate checks on, so forget the variable
+            if (x.lo > x.hi)
+            {
+                env.ranges.erase (d);
+            }
+            else if (x.lo > -INF || x.hi < INF)
+            {
+                env.ranges[d] = x;
+            }
+        }
+
+        // True if id evaluates the same on every iteration of loop: its
+        // subtree, the preorder range [id, end), holds only numbers,
+        // invariant variables and the operators between them
+        bool
+        invariant (uint32_t id, const Loop& loop)
+        {
+            for (uint32_t next = id; next < m_end[id]; ++next)
+            {
+                const AstNode& n = node (next);
+                if (n.kind == AST_VAR)
+                {
+                    int d = declaration (n.token);
+                    if (d < 0 || assignedIn (d, loop) || (!m_local[d] && loop.hasCall))
+                    {
+                        return false;
+                    }
+                }
+                else if (n.kind != AST_NUM && n.kind != AST_BINARY)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void
+        classify (uint32_t id, const Env& env)
+        {
+            const AstNode& n = node (id);
+            uint32_t index = child (id, 0);
+            int d = declaration (n.token);
+            int64_t length = d >= 0 ? m_lengths[d] : -1;
+            Range r = interval (index, env);
+
+            CheckStatus status = CHECK_KEPT;
+            int64_t c;
+            if (length >= 0 && r.lo >= 0 && r.lo <= r.hi && r.hi < length)
+            {
+                status = CHECK_ELIMINATED;
+            }
+            else if (!m_loops.empty ())
+            {
+                const Loop& loop = m_loops.back ();
+                if (invariant (index, loop) ||
+                    (loop.iv >= 0 && env.shift < INF && offsetOf (index, loop.iv, c)))
+                {
+                    status = CHECK_HOISTED;
+                }
+            }
+            m_checks.push_back (BoundsCheck { id, m_function, status });
+        }
+
+        // Walks an expression in evaluation order, classifying subscripts
+        // and tracking assignments. An assignment or subscript comes back
+        // off the stack once its operands have been walked; an assignment
+        // carries the range of its value, taken before the value is walked.
+        void
+        visit (uint32_t id, Env& env)
+        {
+            struct Pending
+            {
+                uint32_t id;
+                bool operandsDone;
+                Range value;
+            };
+            std::vector<Pending> pending (1, Pending { id, false, UNKNOWN });
+            while (!pending.empty ())
+            {
+                Pending p = pending.back ();
+                pending.pop_back ();
+                const AstNode& n = node (p.id);
+                switch (n.kind)
+                {
+                    case AST_ASSIGN:
+                    {
+                        uint32_t target = child (p.id, 0);
+                        uint32_t value = child (p.id, 1);
+                        if (!p.operandsDone)
+                        {
+                            pending.push_back (Pending { p.id, true, interval (value, env) });
+                            pending.push_back (Pending { value, false, UNKNOWN });
+                            break;
+                        }
+                        const AstNode& t = node (target);
+                        if (t.kind == AST_SUBSCRIPT)
+                        {
+                            pending.push_back (Pending { target, false, UNKNOWN });
+                            break;
+                        }
+                        int d = declaration (t.token);
+                        if (d < 0 || !m_local[d])
+                        {
+                            break;
+                        }
+                        Range r = p.value;
+                        if (r.lo > -INF || r.hi < INF)
+                        {
+                            env.ranges[d] = r;
+                        }
+                        else
+                        {
+                            env.ranges.erase (d);
+                        }
+                        int64_t c;
+                        if (!m_loops.empty () && m_loops.back ().iv == d)
+                        {
+                            env.shift = offsetOf (value, d, c) ? addBound (env.shift, c) : INF;
+                        }
+                        break;
+                    }
+
+                    case AST_SUBSCRIPT:
+                        if (!p.operandsDone)
+                        {
+                            pending.push_back (Pending { p.id, true, UNKNOWN });
+                            pending.push_back (Pending { child (p.id, 0), false, UNKNOWN });
+                        }
+                        else
+                        {
+                            classify (p.id, env);
+                        }
+                        break;
+
+                    case AST_BINARY:
+                    case AST_CALL:
+                        for (uint32_t k = n.childCount; k > 0; --k)
+                        {
+                            pending.push_back (Pending { child (p.id, k - 1), false, UNKNOWN });
+                        }
+                        break;
+
+                    default:
+                        break;
+                }
+            }
+        }
+
+        bool
+        assignedIn (int d, const Loop& loop)
+        {
+            std::unordered_map<int, std::vector<uint32_t>>::const_iterator a = m_assignments.find (d);
+            return a != m_assignments.end () && within (a->second, loop);
+        }
+
+        bool
+        onlyIncrementedIn (int d, const Loop& loop)
+        {
+            std::unordered_map<int, std::vector<uint32_t>>::const_iterator a = m_otherAssignments.find (d);
+            return a == m_otherAssignments.end () || !within (a->second, loop);
+        }
+
+        // True if no increment of d in loop can wrap, so d really only
+        // grows: the test keeps it at most the bound (less one for < and >)
+        // at the top of the body, and each increment outside a nested loop
+        // runs at most once per iteration
+        bool
+        incrementsFit (uint32_t cond, int d, const Loop& loop, const Env& env)
+        {
+            const AstNode& c = node (cond);
+            bool strict = c.op == LT || c.op == GT;
+            Range bound = finite (interval (child (cond, c.op == LT || c.op == LTE ? 1 : 0), env));
+            int64_t most = bound.hi - (strict ? 1 : 0);
+            for (uint32_t a : m_assignments.find (d)->second)
+            {
+                int64_t step;
+                if (a < loop.begin || a >= loop.end)
+                {
+                    continue;
+                }
+                if (m_loopOf[a] != loop.begin || !offsetOf (child (a, 1), d, step))
+                {
+                    return false;
+                }
+                most += step;
+                if (most > INT32_MAX)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Sets up top, what holds at the test of the while loop id on
+        // every iteration, and body, what holds at the start of its body
+        void
+        enterLoop (uint32_t id, Env& env, Env& top, Env& body)
+        {
+            uint32_t cond = child (id, 0);
+            Loop loop = { id, m_end[id], m_callsBefore[m_end[id]] > m_callsBefore[id], -1 };
+
+            // while (i < n) and the like, with i only ever incremented
+            const AstNode& c = node (cond);
+            if (c.kind == AST_BINARY && (c.op == LT || c.op == LTE || c.op == GT || c.op == GTE))
+            {
+                bool ivLeft = c.op == LT || c.op == LTE;
+                uint32_t var = child (cond, ivLeft ? 0 : 1);
+                uint32_t bound = child (cond, ivLeft ? 1 : 0);
+                int d = node (var).kind == AST_VAR ? declaration (node (var).token) : -1;
+                if (d >= 0 && m_local[d] && assignedIn (d, loop) && onlyIncrementedIn (d, loop) &&
+                    invariant (bound, loop) && incrementsFit (cond, d, loop, env))
+                {
+                    loop.iv = d;
+                }
+            }
+
+            if (!m_loops.empty () && m_loops.back ().iv >= 0 &&
+                assignedIn (m_loops.back ().iv, loop))
+            {
+                env.shift = INF;
+            }
+            int64_t entryLo = -INF;
+            if (loop.iv >= 0 && env.ranges.count (loop.iv) > 0)
+            {
+                entryLo = env.ranges[loop.iv].lo;
+            }
+
+            // Every iteration starts from what holds on entry, less what
+            // the loop changes
+            top = env;
+            top.shift = INF;
+            for (std::map<uint32_t, Range>::iterator r = top.ranges.begin (); r != top.ranges.end (); )
+            {
+                r = assignedIn (r->first, loop) ? top.ranges.erase (r) : std::next (r);
+            }
+            if (loop.iv >= 0 && entryLo > -INF)
+            {
+                top.ranges[loop.iv] = Range { entryLo, INF };
+            }
+
+            // The test bounds i from above in the body, and since i only
+            // grows, the entry value bounds it from below
+            m_loops.push_back (loop);
+            visit (cond, top);
+            body = top;
+            refine (cond, body, true);
+            if (loop.iv >= 0)
+            {
+                body.shift = 0;
+            }
+        }
+
+        // After the body of the while loop id has been walked
+        void
+        exitLoop (uint32_t id, Env& env, Env& top)
+        {
+            m_loops.pop_back ();
+            int64_t shift = env.shift;
+            env = std::move (top);
+            refine (child (id, 0), env, false);
+            env.shift = shift;
+        }
+
+        enum Step
+        {
+            STMT,           // walk the statement
+            JOIN_IF,        // both branches of the if are walked
+            EXIT_LOOP       // the body of the while is walked
+        };
+
+        struct Pending
+        {
+            Step step;
+            uint32_t id;
+            uint32_t env;   // index into the stack of environments
+        };
+
+        // Walks a statement with explicit stacks, so nesting depth costs
+        // heap rather than C++ stack. An if pushes the environment of its
+        // taken branch, and a while those of its test and body; each is
+        // popped when its JOIN_IF or EXIT_LOOP comes off the stack, and
+        // everything pushed by the statements between has gone by then.
+        void
+        stmt (uint32_t id, Env& env)
+        {
+            std::vector<Env> envs (1, std::move (env));
+            std::vector<Pending> pending (1, Pending { STMT, id, 0 });
+            while (!pending.empty ())
+            {
+                Pending p = pending.back ();
+                pending.pop_back ();
+                if (p.step == JOIN_IF)
+                {
+                    envs[p.env] = join (envs.back (), envs[p.env]);
+                    envs.pop_back ();
+                    continue;
+                }
+                if (p.step == EXIT_LOOP)
+                {
+                    exitLoop (p.id, envs[p.env], envs[envs.size () - 2]);
+                    envs.resize (envs.size () - 2);
+                    continue;
+                }
+
+                const AstNode& n = node (p.id);
+                switch (n.kind)
+                {
+                    case AST_COMPOUND:
+                        for (uint32_t k = n.childCount; k > 0; --k)
+                        {
+                            pending.push_back (Pending { STMT, child (p.id, k - 1), p.env });
+                        }
+                        break;
+
+                    case AST_VAR_DECL:
+                    case AST_ARRAY_DECL:
+                        declare (n, envs[p.env]);
+                        break;
+
+                    case AST_EXPR_STMT:
+                    case AST_RETURN:
+                        if (n.childCount > 0)
+                        {
+                            visit (child (p.id, 0), envs[p.env]);
+                        }
+                        envs[p.env].dead = envs[p.env].dead || n.kind == AST_RETURN;
+                        break;
+
+                    case AST_IF:
+                    {
+                        uint32_t cond = child (p.id, 0);
+                        visit (cond, envs[p.env]);
+                        Env taken = envs[p.env];
+                        refine (cond, taken, true);
+                        refine (cond, envs[p.env], false);
+                        envs.push_back (std::move (taken));
+                        pending.push_back (Pending { JOIN_IF, p.id, p.env });
+                        if (n.childCount > 2)
+                        {
+                            pending.push_back (Pending { STMT, child (p.id, 2), p.env });
+                        }
+                        pending.push_back (Pending { STMT, child (p.id, 1), (uint32_t) envs.size () - 1 });
+                        break;
+                    }
+
+                    case AST_WHILE:
+                    {
+                        envs.resize (envs.size () + 2);
+                        enterLoop (p.id, envs[p.env], envs[envs.size () - 2], envs.back ());
+                        pending.push_back (Pending { EXIT_LOOP, p.id, p.env });
+                        pending.push_back (Pending { STMT, child (p.id, 1), (uint32_t) envs.size () - 1 });
+                        break;
+                    }
+
+                    default:
+                        break;
+                }
+            }
+            env = std::move (envs[0]);
+        }
+
+    private:
+        const Ast& m_ast;
+        const SymbolTable& m_symbols;
+        const std::vector<int32_t>& m_lengths;
+        const std::vector<bool>& m_local;
+        std::vector<BoundsCheck>& m_checks;
+        std::vector<Loop> m_loops;
+        const std::vector<uint32_t>& m_end;
+        const std::vector<uint32_t>& m_callsBefore;
+        const std::vector<uint32_t>& m_loopOf;
+        const std::unordered_map<int, std::vector<uint32_t>>& m_assignments;
+        const std::unordered_map<int, std::vector<uint32_t>>& m_otherAssignments;
+        uint32_t m_function;
+    };
+}
+
+/***********************/
+
+BoundsAnalysis::BoundsAnalysis (const Ast& ast, const std::vector<Token>& tokens,
+                                WorkStealingPool* pool)
+    : m_ast (ast), m_tokens (tokens)
+{
+    if (ast.nodes ().empty ())
+    {
+        return;
+    }
+    Index index (ast, tokens);
+    std::vector<std::vector<BoundsCheck>> found (index.functions.size ());
+    std::function<void (size_t)> task = [&] (size_t i) {
+        Walker (index, found[i]).function (index.functions[i]);
+    };
+    if (pool != NULL)
+    {
+        pool->run (index.functions.size (), task);
+    }
+    else
+    {
+        for (size_t i = 0; i < index.functions.size (); ++i)
+        {
+            task (i);
+        }
+    }
+    for (const std::vector<BoundsCheck>& checks : found)
+    {
+        m_checks.insert (m_checks.end (), checks.begin (), checks.end ());
+    }
+    std::sort (m_checks.begin (), m_checks.end (), [] (const BoundsCheck& a, const BoundsCheck& b) {
+        return a.node < b.node;
+    });
+}
+
+BoundsAnalysis::~BoundsAnalysis ()
+{
+}
+
+const std::vector<BoundsCheck>&
+BoundsAnalysis::checks () const
+{
+    return m_checks;
+}
+
+CheckStatus
+BoundsAnalysis::status (uint32_t node) const
+{
+    std::vector<BoundsCheck>::const_iterator found =
+        std::lower_bound (m_checks.begin (), m_checks.end (), node,
+                          [] (const BoundsCheck& c, uint32_t n) { return c.node < n; });
+    return found != m_checks.end () && found->node == node ? found->status : CHECK_KEPT;
+}
+
+std::vector<std::string>
+BoundsAnalysis::report () const
+{
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < m_checks.size (); )
+    {
+        uint32_t function = m_checks[i].function;
+        int counts[3] = { 0, 0, 0 };
+        size_t total = 0;
+        for (; i < m_checks.size () && m_checks[i].function == function; ++i, ++total)
+        {
+            ++counts[m_checks[i].status];
+        }
+        char line[256];
+        snprintf (line, sizeof (line),
+                  "bounds: %s: %zu checks, %d eliminated (%.1f%%), %d hoisted (%.1f%%)",
+                  m_tokens[m_ast.nodes ()[function].token].lexeme.c_str (), total,
+                  counts[CHECK_ELIMINATED], 100.0 * counts[CHECK_ELIMINATED] / total,
+                  counts[CHECK_HOISTED], 100.0 * counts[CHECK_HOISTED] / total);
+        lines.push_back (line);
+    }
+    return lines;
+}
@@ -0,0 +1,88 @@
+/*
+    Filename    : BoundsCheck.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Bounds-Check Elimination
+*/
+
+/***********************/
+
+#ifndef BOUNDS_CHECK_H
+#define BOUNDS_CHECK_H
+
+/***********************/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Ast.h"
+#include "Lexer.h"
+#include "WorkStealingPool.h"
+
+/***********************/
+
+enum CheckStatus
+{
+    CHECK_KEPT,             // checked at every access
+    CHECK_HOISTED,          // one check before the innermost loop covers it
+    CHECK_ELIMINATED        // always in range
+};
+
+struct BoundsCheck
+{
+    uint32_t node;          // the AST_SUBSCRIPT
+    uint32_t function;      // its AST_FUN_DECL
+    CheckStatus status;
+};
+
+// Decides for every subscript how much of its bounds check a back end
+// needs, using interval ranges of scalar locals. Ranges come from
+// assignments of known values, and from while loops of the form
+//
+//   while (i < n)   (or <=, or n > i, n >= i)
+//
+// where every assignment to i in the loop adds a positive constant, n
+// does not change in the loop, and no addition can carry i past INT_MAX:
+// in the body i lies between its value at the loop entry and n - 1, plus
+// whatever the body has added so far. ints wrap, so any arithmetic that
+// might leave the int range gives no range at all.
+//
+// A check that is not always in range is hoisted when it would check the
+// same thing on every iteration (the index does not change in the loop),
+// or when the index is the loop's induction variable plus a constant, so
+// the range the loop covers can be checked once up front. A back end
+// using hoisted checks must fall back to checking every access when the
+// check before the loop fails, since the access may be conditional.
+//
+// Functions are analyzed independently; with a pool each one is a task,
+// and the result does not depend on how they were scheduled.
+class BoundsAnalysis
+{
+public:
+    BoundsAnalysis (const Ast& ast, const std::vector<Token>& tokens,
+                    WorkStealingPool* pool = NULL);
+
+    ~BoundsAnalysis ();
+
+    // Every subscript, in preorder
+    const std::vector<BoundsCheck>&
+    checks () const;
+
+    CheckStatus
+    status (uint32_t node) const;
+
+    // One line per function that has subscripts, with the fraction of
+    // its checks eliminated and hoisted
+    std::vector<std::string>
+    report () const;
+
+private:
+    const Ast& m_ast;
+    const std::vector<Token>& m_tokens;
+    std::vector<BoundsCheck> m_checks;
+};
+
+/***********************/
+
+#endif
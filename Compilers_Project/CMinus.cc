@@ -7,13 +7,33 @@
 
 
 #include <iostream>
+#include <cctype>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "Ast.h"
+#include "BinaryFormat.h"
+#include "BoundsCheck.h"
+#include "ConstEval.h"
+#include "Dataflow.h"
+#include "FlexScanner.h"
+#include "Interpreter.h"
+#include "LanguageServer.h"
 #include "Lexer.h"
+#include "LLParser.h"
+#include "ParallelLexer.h"
+#include "ParseCache.h"
 #include "Parser.h"
+#include "TailCall.h"
+#include "TokenQueue.h"
+#include "VectorLoops.h"
+#include "WorkStealingPool.h"
 
 using std::cout;
 using std::endl;
@@ -27,11 +47,403 @@ using std::endl;
 //int
 //yylex ();
 
+// What to do with the syntax tree after parsing
+struct Analyses
+{
+    bool fold;
+    bool dataflow;
+    bool bounds;
+    bool tailCalls;
+    bool vector;
+    unsigned jobs;
+
+    bool
+    any () const
+    {
+        return fold || dataflow || bounds || tailCalls || vector;
+    }
+};
+
+// --fold: replaces calls to pure functions with constant arguments by
+// their results
+static Ast
+fold (const Ast& ast, const std::vector<Token>& tokens, FILE* report)
+{
+    ConstEvalStats stats;
+    Ast folded = foldConstantCalls (ast, tokens, stats);
+    fprintf (report, "%s\n", stats.report ().c_str ());
+    return folded;
+}
+
+// --emit: writes the tokens, and for "ast" the syntax tree, to stdout in
+// the format of BinaryFormat.h. Diagnostics go to stderr instead, and an
+// invalid program writes nothing for "ast". With --fold the tree is the
+// folded one.
+static int
+emit (std::vector<Token> tokens, const std::string& what, bool folding)
+{
+    if (what == "tokens")
+    {
+        return writeBinary (stdout, tokens, NULL) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    Ast ast;
+    Parser pars (std::move (tokens));
+    std::string message = pars.parse (ast);
+    if (!message.empty ())
+    {
+        fprintf (stderr, "%s", message.c_str ());
+        return EXIT_FAILURE;
+    }
+    if (folding)
+    {
+        ast = fold (ast, pars.m_tokens, stderr);
+    }
+    return writeBinary (stdout, pars.m_tokens, &ast) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// --run: interprets the program, reading input () from stdin and writing
+// output () to stdout. Diagnostics, and the --fold, --run-stats and
+// --run-profile reports, go to stderr; the --run-profile samples go to
+// profilePath.
+static int
+execute (std::vector<Token> tokens, bool folding, const InterpreterLimits& limits, bool stats,
+         const std::string& profilePath)
+{
+    Ast ast;
+    Parser pars (std::move (tokens));
+    std::string message = pars.parse (ast);
+    if (message.empty ())
+    {
+        if (folding)
+        {
+            ast = fold (ast, pars.m_tokens, stderr);
+        }
+        Interpreter interpreter (ast, pars.m_tokens, limits);
+        if (!profilePath.empty ())
+        {
+            // CMINUS_PROFILE_HZ, as for CMinus-prof, or 1000
+            const char* hz = getenv ("CMINUS_PROFILE_HZ");
+            interpreter.profile (hz != NULL ? atoi (hz) : 1000);
+        }
+        message = interpreter.run (stdin, stdout);
+        if (stats && interpreter.error ().empty ())
+        {
+            fprintf (stderr, "%s\n", interpreter.stats ().report ().c_str ());
+        }
+        if (!profilePath.empty () && interpreter.error ().empty ())
+        {
+            fprintf (stderr, "%s", interpreter.profileReport ().c_str ());
+            FILE* out = fopen (profilePath.c_str (), "w");
+            if (out == NULL)
+            {
+                perror (profilePath.c_str ());
+                return EXIT_FAILURE;
+            }
+            interpreter.writeFolded (out);
+            fclose (out);
+        }
+    }
+    if (!message.empty ())
+    {
+        fprintf (stderr, "%s", message.c_str ());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// The analyses: parses, then prints what they found before "Valid!".
+// Folding runs first, so the others see the folded tree. The dataflow
+// solver's work goes to stderr. With jobs threads the functions are
+// analyzed in parallel; the output is the same.
+static int
+analyze (std::vector<Token> tokens, const Analyses& analyses)
+{
+    Ast ast;
+    Parser pars (std::move (tokens));
+    std::string message = pars.parse (ast);
+    if (!message.empty ())
+    {
+        printf ("%s", message.c_str ());
+        return EXIT_FAILURE;
+    }
+    if (analyses.fold)
+    {
+        ast = fold (ast, pars.m_tokens, stdout);
+    }
+    std::unique_ptr<WorkStealingPool> pool;
+    if (analyses.jobs != 1)
+    {
+        pool.reset (new WorkStealingPool (analyses.jobs));
+    }
+    if (analyses.dataflow)
+    {
+        DataflowStats stats;
+        for (const std::string& warning : dataflowWarnings (ast, pars.m_tokens, stats, pool.get ()))
+        {
+            printf ("%s\n", warning.c_str ());
+        }
+        fprintf (stderr, "dataflow: %u functions, %llu blocks, %llu variables, %llu block visits, %.3f ms\n",
+                 stats.functions, (unsigned long long) stats.blocks,
+                 (unsigned long long) stats.variables, (unsigned long long) stats.iterations,
+                 stats.seconds * 1e3);
+    }
+    if (analyses.bounds)
+    {
+        for (const std::string& line : BoundsAnalysis (ast, pars.m_tokens, pool.get ()).report ())
+        {
+            printf ("%s\n", line.c_str ());
+        }
+    }
+    if (analyses.tailCalls)
+    {
+        for (const std::string& line : TailCallAnalysis (ast, pars.m_tokens).report ())
+        {
+            printf ("%s\n", line.c_str ());
+        }
+    }
+    if (analyses.vector)
+    {
+        for (const std::string& line : VectorLoopAnalysis (ast, pars.m_tokens).report ())
+        {
+            printf ("%s\n", line.c_str ());
+        }
+    }
+    printf ("Valid!\n");
+    return EXIT_SUCCESS;
+}
+
+// More threads than this only adds contention
+static const long MAX_JOBS = 256;
+
+// --jobs=N: a whole number from 0 to MAX_JOBS; false otherwise
+static bool
+parseJobs (const char* text, unsigned& jobs)
+{
+    char* end;
+    errno = 0;
+    long n = strtol (text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || n < 0 || n > MAX_JOBS)
+    {
+        return false;
+    }
+    jobs = n;
+    return true;
+}
+
+// --max-memory=N: digits with no suffix, K, M or G; false otherwise,
+// or if the bytes do not fit in a size_t
+static bool
+parseBytes (const char* text, size_t& bytes)
+{
+    if (!isdigit ((unsigned char) text[0]))
+    {
+        return false;
+    }
+    char* suffix;
+    errno = 0;
+    unsigned long long n = strtoull (text, &suffix, 10);
+    std::string scale (suffix);
+    int shift = scale == "K" ? 10 : scale == "M" ? 20 : scale == "G" ? 30 : 0;
+    if (errno != 0 || (shift == 0 && !scale.empty ()) || n > (size_t) -1 >> shift)
+    {
+        return false;
+    }
+    bytes = (size_t) n << shift;
+    return true;
+}
+
 int
 main (int argc, char* argv[])
 {
     ++argv;
     --argc;
+
+    // Options come before the source file
+    //   --pipeline        lex on a second thread while the parser consumes tokens
+    //   --lex-threads=N   lex the file as N chunks in parallel, then parse
+    //   --serve           run as a language server on stdin/stdout
+    //   --cache-dir=DIR   reuse results for sources already checked, keyed
+    //                     by a hash of their bytes
+    //   --parser=ll1      parse with the table-driven LLParser instead of
+    //                     the recursive-descent Parser
+    //   --lexer=flex      lex with the flex-generated FlexScanner instead
+    //                     of the hand-written Lexer
+    //   --emit=tokens|ast write the tokens or the syntax tree to stdout in
+    //                     binary instead of printing "Valid!"
+    //   --dataflow        also warn about locals read before they are
+    //                     assigned and assignments that are never read
+    //   --bounds          report per function how many array bounds checks
+    //                     range analysis removes or hoists out of loops
+    //   --tail-calls      report per function the 'return f (...)' calls
+    //                     that can become jumps
+    //   --fold            replace calls to pure functions with constant
+    //                     arguments by their results, before any analysis
+    //                     or --emit=ast
+    //   --vector          report per function the reduction and
+    //                     elementwise array loops a back end can vectorize
+    //   --jobs=N          run --dataflow and --bounds on N threads, one
+    //                     function at a time per thread; 0 is one per core,
+    //                     and at most 256
+    //   --run             interpret the program instead of printing
+    //                     "Valid!"; input () reads stdin, so give the
+    //                     source as a file
+    //   --max-memory=N    stop --run when globals and the frame arena need
+    //                     more than N bytes (K, M and G suffixes allowed)
+    //   --max-calls=N     stop --run when more than N calls are in progress
+    //   --run-stats       after --run, report calls, call depth and the
+    //                     most memory frames used
+    //   --run-profile=F   after --run, report calls and statements per
+    //                     function and how often each test held, and
+    //                     write sampled call stacks to F in folded form
+    bool pipeline = false;
+    unsigned lexThreads = 0;
+    std::string cacheDir;
+    bool ll1 = false;
+    bool flex = false;
+    std::string emitWhat;
+    bool run = false;
+    InterpreterLimits limits;
+    bool runStats = false;
+    std::string profilePath;
+    Analyses analyses = { false, false, false, false, false, 1 };
+    while (argc > 0 && std::string (argv[0]).compare (0, 2, "--") == 0)
+    {
+        std::string option (argv[0]);
+        if (option == "--pipeline")
+        {
+            pipeline = true;
+        }
+        else if (option == "--serve")
+        {
+            LanguageServer server (stdin, stdout);
+            return server.run ();
+        }
+        else if (option.compare (0, 14, "--lex-threads=") == 0)
+        {
+            lexThreads = atoi (option.c_str () + 14);
+        }
+        else if (option == "--parser=ll1" || option == "--parser=rd")
+        {
+            ll1 = option == "--parser=ll1";
+        }
+        else if (option == "--lexer=flex" || option == "--lexer=hand")
+        {
+            flex = option == "--lexer=flex";
+        }
+        else if (option == "--emit=tokens" || option == "--emit=ast")
+        {
+            emitWhat = option.substr (7);
+        }
+        else if (option == "--dataflow")
+        {
+            analyses.dataflow = true;
+        }
+        else if (option == "--bounds")
+        {
+            analyses.bounds = true;
+        }
+        else if (option == "--tail-calls")
+        {
+            analyses.tailCalls = true;
+        }
+        else if (option == "--fold")
+        {
+            analyses.fold = true;
+        }
+        else if (option == "--vector")
+        {
+            analyses.vector = true;
+        }
+        else if (option == "--run")
+        {
+            run = true;
+        }
+        else if (option.compare (0, 13, "--max-memory=") == 0)
+        {
+            if (!parseBytes (option.c_str () + 13, limits.memory))
+            {
+                fprintf (stderr, "--max-memory takes a number of bytes with an optional K, M or G suffix\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (option.compare (0, 12, "--max-calls=") == 0)
+        {
+            limits.calls = strtoul (option.c_str () + 12, NULL, 10);
+        }
+        else if (option == "--run-stats")
+        {
+            runStats = true;
+        }
+        else if (option.compare (0, 14, "--run-profile=") == 0 && option.size () > 14)
+        {
+            profilePath = option.substr (14);
+        }
+        else if (option.compare (0, 7, "--jobs=") == 0)
+        {
+            if (!parseJobs (option.c_str () + 7, analyses.jobs))
+            {
+                fprintf (stderr, "--jobs takes a number of threads from 0 to %ld\n", MAX_JOBS);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (option.compare (0, 12, "--cache-dir=") == 0)
+        {
+            cacheDir = option.substr (12);
+        }
+        else
+        {
+            fprintf (stderr, "Unknown option: %s\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        ++argv;
+        --argc;
+    }
+
+    if ((pipeline ? 1 : 0) + (lexThreads > 0 ? 1 : 0) + (cacheDir.empty () ? 0 : 1) > 1)
+    {
+        fprintf (stderr, "--pipeline, --lex-threads and --cache-dir cannot be combined\n");
+        return EXIT_FAILURE;
+    }
+    if (ll1 && (pipeline || !cacheDir.empty ()))
+    {
+        fprintf (stderr, "--parser=ll1 cannot be combined with --pipeline or --cache-dir\n");
+        return EXIT_FAILURE;
+    }
+    if (flex && (lexThreads > 0 || !cacheDir.empty ()))
+    {
+        fprintf (stderr, "--lexer=flex cannot be combined with --lex-threads or --cache-dir\n");
+        return EXIT_FAILURE;
+    }
+    if ((!emitWhat.empty () || analyses.any () || run) && (pipeline || ll1 || !cacheDir.empty ()))
+    {
+        fprintf (stderr, "--emit, --run and the analyses cannot be combined with --pipeline, --parser=ll1 or --cache-dir\n");
+        return EXIT_FAILURE;
+    }
+    if (run && (!emitWhat.empty () || analyses.dataflow || analyses.bounds || analyses.tailCalls ||
+                analyses.vector))
+    {
+        fprintf (stderr, "--run can only be combined with --fold\n");
+        return EXIT_FAILURE;
+    }
+    if (!run && (runStats || !profilePath.empty () || limits.memory != InterpreterLimits ().memory ||
+                 limits.calls != InterpreterLimits ().calls))
+    {
+        fprintf (stderr, "--max-memory, --max-calls, --run-stats and --run-profile need --run\n");
+        return EXIT_FAILURE;
+    }
+    if (analyses.jobs != 1 && !analyses.dataflow && !analyses.bounds)
+    {
+        fprintf (stderr, "--jobs needs --dataflow or --bounds\n");
+        return EXIT_FAILURE;
+    }
+#ifndef HAVE_FLEX
+    if (flex)
+    {
+        fprintf (stderr, "CMinus was built without flex; --lexer=flex is unavailable\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
     FILE* srcFile;
     if (argc > 0)
     {
@@ -41,7 +453,102 @@ main (int argc, char* argv[])
     {
         srcFile = stdin;
     }
-    Lexer lex(srcFile);
+    if (!cacheDir.empty ())
+    {
+        std::string source;
+        char buffer[1 << 16];
+        size_t n;
+        while ((n = fread (buffer, 1, sizeof (buffer), srcFile)) > 0)
+        {
+            source.append (buffer, n);
+        }
+
+        ParseCache cache (cacheDir);
+        std::string message;
+        if (cache.lookup (source.data (), source.size ()))
+        {
+            message = cache.diagnostic ();
+        }
+        else
+        {
+            Lexer lex (source.data (), source.size ());
+            Parser pars (lex.tokenize ());
+            message = pars.check ();
+            cache.store (source.data (), source.size (), pars.m_tokens, message);
+        }
+        if (!message.empty ())
+        {
+            printf ("%s", message.c_str ());
+            return EXIT_FAILURE;
+        }
+        printf ("Valid!\n");
+        return EXIT_SUCCESS;
+    }
+    if (lexThreads > 0)
+    {
+        std::vector<Token> tokens = parallelTokenize (srcFile, lexThreads);
+        if (run)
+        {
+            return execute (std::move (tokens), analyses.fold, limits, runStats, profilePath);
+        }
+        if (!emitWhat.empty ())
+        {
+            return emit (std::move (tokens), emitWhat, analyses.fold);
+        }
+        if (analyses.any ())
+        {
+            return analyze (std::move (tokens), analyses);
+        }
+        if (ll1)
+        {
+            LLParser pars (std::move (tokens));
+            pars.start ();
+            return EXIT_SUCCESS;
+        }
+        Parser pars (std::move (tokens));
+        pars.start ();
+        return EXIT_SUCCESS;
+    }
+
+    std::unique_ptr<TokenSource> lex;
+#ifdef HAVE_FLEX
+    if (flex)
+    {
+        lex.reset (new FlexScanner (srcFile));
+    }
+#endif
+    if (!lex)
+    {
+        lex.reset (new Lexer (srcFile));
+    }
+    if (run)
+    {
+        return execute (lex->tokenize (), analyses.fold, limits, runStats, profilePath);
+    }
+    if (!emitWhat.empty ())
+    {
+        return emit (lex->tokenize (), emitWhat, analyses.fold);
+    }
+    if (analyses.any ())
+    {
+        return analyze (lex->tokenize (), analyses);
+    }
+    if (ll1)
+    {
+        LLParser pars (lex->tokenize ());
+        pars.start ();
+        return EXIT_SUCCESS;
+    }
+
+    if (pipeline)
+    {
+        TokenQueue queue;
+        std::thread lexThread ([&lex, &queue] { lex->tokenize (queue); });
+        Parser pars (queue);
+        pars.start ();
+        lexThread.join ();
+        return EXIT_SUCCESS;
+    }
 
     //printf("TOKEN\t\tLEXEME\t\tVALUE\n");
     //printf("=====\t\t======\t\t=====\n");
@@ -51,7 +558,7 @@ main (int argc, char* argv[])
        // "COMMA", "LPAREN", "RPAREN", "LBRACK", "RBRACK", "LBRACE", "RBRACE", "ID", "NUM"};
 
     std::vector<Token> tokenVector;
-    tokenVector = lex.tokenize();
+    tokenVector = lex->tokenize();
     
     //Parser pars(lex.tokenize());
     Parser pars(tokenVector);
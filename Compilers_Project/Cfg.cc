@@ -0,0 +1,371 @@
+/*
+    Filename    : Cfg.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Dataflow Analysis
+*/
+
+/***********************/
+// System includes
+
+#include <utility>
+#include <vector>
+
+/***********************/
+// Local includes
+
+#include "Cfg.h"
+
+/***********************/
+
+Cfg::Cfg (const Ast& ast, SymbolTable& symbols, uint32_t function)
+    : m_ast (ast), m_symbols (symbols), m_params (0), m_firstToken (ast.nodes ()[function].token),
+      m_current (0)
+{
+    newBlock ();
+    newBlock ();
+    m_current = newBlock ();
+    edge (ENTRY, m_current);
+
+    const AstNode& node = ast.nodes ()[function];
+    for (uint32_t k = 0; k < node.childCount; ++k)
+    {
+        uint32_t child = ast.child (function, k);
+        const AstNode& c = ast.nodes ()[child];
+        if (c.kind == AST_PARAM || c.kind == AST_ARRAY_PARAM)
+        {
+            declare (c);
+            ++m_params;
+        }
+        else
+        {
+            stmt (child);
+        }
+    }
+    edge (m_current, EXIT);
+    computeOrder ();
+}
+
+Cfg::~Cfg ()
+{
+}
+
+const std::vector<BasicBlock>&
+Cfg::blocks () const
+{
+    return m_blocks;
+}
+
+uint32_t
+Cfg::variableCount () const
+{
+    return m_declarations.size ();
+}
+
+uint32_t
+Cfg::paramCount () const
+{
+    return m_params;
+}
+
+uint32_t
+Cfg::declaration (uint32_t var) const
+{
+    return m_declarations[var];
+}
+
+bool
+Cfg::isArray (uint32_t var) const
+{
+    return m_arrays[var];
+}
+
+const std::vector<uint32_t>&
+Cfg::order () const
+{
+    return m_order;
+}
+
+uint32_t
+Cfg::newBlock ()
+{
+    m_blocks.push_back (BasicBlock ());
+    return m_blocks.size () - 1;
+}
+
+void
+Cfg::edge (uint32_t from, uint32_t to)
+{
+    m_blocks[from].succs.push_back (to);
+    m_blocks[to].preds.push_back (from);
+}
+
+void
+Cfg::declare (const AstNode& node)
+{
+    uint32_t slot = node.token - m_firstToken;
+    if (slot >= m_variables.size ())
+    {
+        m_variables.resize (slot + 1, -1);
+    }
+    m_variables[slot] = m_declarations.size ();
+    m_declarations.push_back (node.token);
+    m_arrays.push_back (node.kind == AST_ARRAY_DECL || node.kind == AST_ARRAY_PARAM);
+}
+
+// The local variable token refers to, or -1 for a global or an
+// undeclared name
+int
+Cfg::variable (uint32_t token)
+{
+    int declaration = m_symbols.definition (token);
+    if (declaration < (int) m_firstToken ||
+        declaration - m_firstToken >= m_variables.size ())
+    {
+        return -1;
+    }
+    return m_variables[declaration - m_firstToken];
+}
+
+namespace
+{
+    enum Step
+    {
+        STMT,           // add the statement
+        THEN_DONE,      // the then-branch of an if is added; block is the test
+        ELSE_DONE,      // the else-branch is added; block ends the then-branch
+        BODY_DONE       // the body of a while is added; block is the header
+    };
+
+    struct Pending
+    {
+        Step step;
+        uint32_t node;
+        uint32_t block;
+    };
+}
+
+// With an explicit stack, so deeply nested statements do not recurse. An
+// if or while leaves a step behind to join its branches or close its loop
+// once the statements inside have been added.
+void
+Cfg::stmt (uint32_t node)
+{
+    std::vector<Pending> pending (1, Pending { STMT, node, 0 });
+    while (!pending.empty ())
+    {
+        Pending p = pending.back ();
+        pending.pop_back ();
+        const AstNode& n = m_ast.nodes ()[p.node];
+        switch (p.step)
+        {
+            case THEN_DONE:
+                if (n.childCount > 2)
+                {
+                    uint32_t thenEnd = m_current;
+                    m_current = newBlock ();
+                    edge (p.block, m_current);
+                    pending.push_back (Pending { ELSE_DONE, p.node, thenEnd });
+                    pending.push_back (Pending { STMT, m_ast.child (p.node, 2), 0 });
+                }
+                else
+                {
+                    uint32_t thenEnd = m_current;
+                    m_current = newBlock ();
+                    edge (thenEnd, m_current);
+                    edge (p.block, m_current);
+                }
+                continue;
+
+            case ELSE_DONE:
+            {
+                uint32_t elseEnd = m_current;
+                m_current = newBlock ();
+                edge (p.block, m_current);
+                edge (elseEnd, m_current);
+                continue;
+            }
+
+            case BODY_DONE:
+                edge (m_current, p.block);
+                m_current = newBlock ();
+                edge (p.block, m_current);
+                continue;
+
+            case STMT:
+                break;
+        }
+
+        switch (n.kind)
+        {
+            case AST_COMPOUND:
+                for (uint32_t k = n.childCount; k > 0; --k)
+                {
+                    pending.push_back (Pending { STMT, m_ast.child (p.node, k - 1), 0 });
+                }
+                break;
+
+            case AST_VAR_DECL:
+            case AST_ARRAY_DECL:
+                declare (n);
+                break;
+
+            case AST_EXPR_STMT:
+                if (n.childCount > 0)
+                {
+                    expr (m_ast.child (p.node, 0));
+                }
+                break;
+
+            case AST_IF:
+            {
+                expr (m_ast.child (p.node, 0));
+                uint32_t test = m_current;
+                m_current = newBlock ();
+                edge (test, m_current);
+                pending.push_back (Pending { THEN_DONE, p.node, test });
+                pending.push_back (Pending { STMT, m_ast.child (p.node, 1), 0 });
+                break;
+            }
+
+            case AST_WHILE:
+            {
+                uint32_t header = newBlock ();
+                edge (m_current, header);
+                m_current = header;
+                expr (m_ast.child (p.node, 0));
+                m_current = newBlock ();
+                edge (header, m_current);
+                pending.push_back (Pending { BODY_DONE, p.node, header });
+                pending.push_back (Pending { STMT, m_ast.child (p.node, 1), 0 });
+                break;
+            }
+
+            case AST_RETURN:
+                if (n.childCount > 0)
+                {
+                    expr (m_ast.child (p.node, 0));
+                }
+                edge (m_current, EXIT);
+                // Whatever follows is unreachable
+                m_current = newBlock ();
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+// Also with an explicit stack; an assignment or subscript comes back off
+// it once its operands have been read
+void
+Cfg::expr (uint32_t node)
+{
+    std::vector<std::pair<uint32_t, bool>> pending (1, std::make_pair (node, false));
+    while (!pending.empty ())
+    {
+        uint32_t next = pending.back ().first;
+        bool operandsDone = pending.back ().second;
+        pending.pop_back ();
+        const AstNode& n = m_ast.nodes ()[next];
+        switch (n.kind)
+        {
+            case AST_ASSIGN:
+            {
+                uint32_t target = m_ast.child (next, 0);
+                const AstNode& t = m_ast.nodes ()[target];
+                if (!operandsDone)
+                {
+                    pending.push_back (std::make_pair (next, true));
+                    pending.push_back (std::make_pair (m_ast.child (next, 1), false));
+                }
+                else if (t.kind == AST_SUBSCRIPT)
+                {
+                    pending.push_back (std::make_pair (target, false));
+                }
+                else
+                {
+                    access (t.token, true);
+                }
+                break;
+            }
+
+            case AST_VAR:
+                access (n.token, false);
+                break;
+
+            case AST_SUBSCRIPT:
+                if (!operandsDone)
+                {
+                    pending.push_back (std::make_pair (next, true));
+                    pending.push_back (std::make_pair (m_ast.child (next, 0), false));
+                }
+                else
+                {
+                    access (n.token, false);
+                }
+                break;
+
+            case AST_BINARY:
+            case AST_CALL:
+                for (uint32_t k = n.childCount; k > 0; --k)
+                {
+                    pending.push_back (std::make_pair (m_ast.child (next, k - 1), false));
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+void
+Cfg::access (uint32_t token, bool def)
+{
+    int var = variable (token);
+    if (var >= 0)
+    {
+        // Assigning a whole array is a type error; it defines nothing
+        m_blocks[m_current].accesses.push_back (CfgAccess { (uint32_t) var, def && !m_arrays[var], token });
+    }
+}
+
+// Depth-first from the entry with an explicit stack, so long chains of
+// blocks do not recurse
+void
+Cfg::computeOrder ()
+{
+    std::vector<bool> seen (m_blocks.size (), false);
+    std::vector<std::pair<uint32_t, uint32_t>> pending (1, std::make_pair (ENTRY, 0u));
+    seen[ENTRY] = true;
+    while (!pending.empty ())
+    {
+        uint32_t block = pending.back ().first;
+        uint32_t next = pending.back ().second++;
+        if (next < m_blocks[block].succs.size ())
+        {
+            uint32_t succ = m_blocks[block].succs[next];
+            if (!seen[succ])
+            {
+                seen[succ] = true;
+                pending.push_back (std::make_pair (succ, 0u));
+            }
+        }
+        else
+        {
+            m_order.push_back (block);
+            pending.pop_back ();
+        }
+    }
+    std::vector<uint32_t> reversed (m_order.rbegin (), m_order.rend ());
+    for (uint32_t b = 0; b < m_blocks.size (); ++b)
+    {
+        if (!seen[b])
+        {
+            reversed.push_back (b);
+        }
+    }
+    m_order = std::move (reversed);
+}
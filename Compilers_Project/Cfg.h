@@ -0,0 +1,121 @@
+/*
+    Filename    : Cfg.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Dataflow Analysis
+*/
+
+/***********************/
+
+#ifndef CFG_H
+#define CFG_H
+
+/***********************/
+
+#include <cstdint>
+#include <vector>
+
+#include "Ast.h"
+#include "SymbolTable.h"
+
+/***********************/
+
+// A read or write of one of the function's variables, in evaluation order
+struct CfgAccess
+{
+    uint32_t var;
+    bool     def;
+    uint32_t token;         // the ID
+};
+
+struct BasicBlock
+{
+    std::vector<CfgAccess> accesses;
+    std::vector<uint32_t> succs;
+    std::vector<uint32_t> preds;
+};
+
+// Control-flow graph of one function, reduced to what dataflow analyses
+// over its variables need. The variables are its parameters and local
+// declarations, numbered densely in declaration order with the
+// parameters first; globals are not tracked. Block 0 is the entry and
+// block 1 the exit, which every return and the end of the body reach.
+//
+// An assignment reads its value (and any subscript) before it writes the
+// target. Writing an element of an array reads the array rather than
+// defining it, since the rest of the array keeps its old contents.
+class Cfg
+{
+public:
+    static constexpr uint32_t ENTRY = 0;
+    static constexpr uint32_t EXIT = 1;
+
+    // function is the AST_FUN_DECL node; uses resolve through symbols
+    Cfg (const Ast& ast, SymbolTable& symbols, uint32_t function);
+
+    ~Cfg ();
+
+    const std::vector<BasicBlock>&
+    blocks () const;
+
+    uint32_t
+    variableCount () const;
+
+    uint32_t
+    paramCount () const;
+
+    // Declaring token of var
+    uint32_t
+    declaration (uint32_t var) const;
+
+    bool
+    isArray (uint32_t var) const;
+
+    // Blocks in reverse postorder from the entry; unreachable blocks last
+    const std::vector<uint32_t>&
+    order () const;
+
+private:
+    uint32_t
+    newBlock ();
+
+    void
+    edge (uint32_t from, uint32_t to);
+
+    void
+    declare (const AstNode& node);
+
+    int
+    variable (uint32_t token);
+
+    void
+    stmt (uint32_t node);
+
+    void
+    expr (uint32_t node);
+
+    void
+    access (uint32_t token, bool def);
+
+    void
+    computeOrder ();
+
+private:
+    const Ast& m_ast;
+    SymbolTable& m_symbols;
+    std::vector<BasicBlock> m_blocks;
+    std::vector<uint32_t> m_declarations;
+    std::vector<bool> m_arrays;
+    uint32_t m_params;
+    std::vector<uint32_t> m_order;
+
+    // Variable of each declaring token in the function's token span
+    uint32_t m_firstToken;
+    std::vector<int> m_variables;
+
+    uint32_t m_current;
+};
+
+/***********************/
+
+#endif
@@ -0,0 +1,662 @@
+/*
+    Filename    : ConstEval.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Constant Evaluation
+*/
+
+/***********************/
+// System includes
+
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "ConstEval.h"
+#include "SymbolTable.h"
+
+/***********************/
+
+std::string
+ConstEvalStats::report () const
+{
+    char line[256];
+    snprintf (line, sizeof (line),
+              "fold: %u of %u calls to %u pure functions folded, %u not constant, "
+              "%u out of fuel, %u too deep, %u errors, %llu steps",
+              folded, sites, pureFunctions, notConstant, outOfFuel, tooDeep, errors,
+              (unsigned long long) steps);
+    return line;
+}
+
+/***********************/
+
+namespace
+{
+    // Values are 32-bit; UNSET marks a variable or element not yet assigned
+    const int64_t UNSET = INT64_MIN;
+
+    // Guards the evaluator's own stack against deeply nested code
+    const uint32_t MAX_NESTING = 4096;
+
+    enum Outcome
+    {
+        OK, RETURNED, NOT_CONSTANT, OUT_OF_FUEL, TOO_DEEP, FAILED
+    };
+
+    // A scalar, or an array passed by reference
+    struct Value
+    {
+        int64_t scalar;
+        std::vector<int64_t>* array;
+    };
+
+    struct Frame
+    {
+        std::unordered_map<int, int64_t> scalars;
+        std::unordered_map<int, std::vector<int64_t>*> arrays;
+        std::deque<std::vector<int64_t>> storage;
+    };
+
+    int64_t
+    wrap (int64_t v)
+    {
+        return (int32_t) (uint32_t) (uint64_t) v;
+    }
+
+    class Evaluator
+    {
+    public:
+        Evaluator (const Ast& ast, const std::vector<Token>& tokens, const ConstEvalLimits& limits)
+            : m_ast (ast), m_symbols (tokens), m_limits (limits), m_end (ast.nodes ().size ()),
+              m_fuel (0), m_calls (0), m_nesting (0)
+        {
+            const std::vector<AstNode>& nodes = ast.nodes ();
+            for (uint32_t id = nodes.size (); id-- > 0; )
+            {
+                m_end[id] = id + 1;
+                if (nodes[id].childCount > 0)
+                {
+                    m_end[id] = m_end[ast.child (id, nodes[id].childCount - 1)];
+                }
+            }
+            findPure (tokens.size ());
+        }
+
+        uint32_t
+        pureCount () const
+        {
+            uint32_t count = 0;
+            for (const std::pair<const uint32_t, bool>& p : m_pure)
+            {
+                count += p.second;
+            }
+            return count;
+        }
+
+        uint32_t
+        end (uint32_t id) const
+        {
+            return m_end[id];
+        }
+
+        // True if id calls a pure int function
+        bool
+        candidate (uint32_t id)
+        {
+            int f = callee (id);
+            return f >= 0 && m_pure[f] && node (f).op == INT;
+        }
+
+        // Runs the call at id with a fresh allowance of fuel
+        Outcome
+        fold (uint32_t id, int64_t& result, uint64_t& steps)
+        {
+            m_fuel = m_limits.fuel;
+            m_calls = 0;
+            m_nesting = 0;
+            Value v;
+            Outcome o = expr (id, NULL, v);
+            steps = m_limits.fuel - m_fuel;
+            result = v.scalar;
+            return o;
+        }
+
+    private:
+        const AstNode&
+        node (uint32_t id)
+        {
+            return m_ast.nodes ()[id];
+        }
+
+        uint32_t
+        child (uint32_t id, uint32_t k)
+        {
+            return m_ast.child (id, k);
+        }
+
+        int
+        declaration (uint32_t token)
+        {
+            return m_symbols.definition (token);
+        }
+
+        // The AST_FUN_DECL a call resolves to, or -1
+        int
+        callee (uint32_t call)
+        {
+            std::unordered_map<int, uint32_t>::const_iterator f =
+                m_functions.find (declaration (node (call).token));
+            return f != m_functions.end () ? (int) f->second : -1;
+        }
+
+        // A function is impure if it touches a global or calls anything
+        // that is not a pure function; impurity then spreads to callers
+        void
+        findPure (size_t tokens)
+        {
+            const std::vector<AstNode>& nodes = m_ast.nodes ();
+            if (nodes.empty ())
+            {
+                return;
+            }
+            std::vector<bool> global (tokens, false);
+            for (uint32_t k = 0; k < nodes[0].childCount; ++k)
+            {
+                uint32_t d = child (0, k);
+                global[nodes[d].token] = true;
+                if (nodes[d].kind == AST_FUN_DECL)
+                {
+                    m_functions[nodes[d].token] = d;
+                }
+            }
+            std::map<uint32_t, std::vector<uint32_t>> callers;
+            std::vector<uint32_t> impure;
+            for (const std::pair<const int, uint32_t>& f : m_functions)
+            {
+                bool pure = true;
+                for (uint32_t id = f.second + 1; id < m_end[f.second]; ++id)
+                {
+                    const AstNode& n = nodes[id];
+                    if (n.kind == AST_CALL)
+                    {
+                        int c = callee (id);
+                        pure = pure && c >= 0;
+                        if (c >= 0)
+                        {
+                            callers[c].push_back (f.second);
+                        }
+                    }
+                    else if (n.kind == AST_VAR || n.kind == AST_SUBSCRIPT)
+                    {
+                        int d = declaration (n.token);
+                        pure = pure && d >= 0 && !global[d];
+                    }
+                    else if (n.kind == AST_EMPTY)
+                    {
+                        pure = false;
+                    }
+                }
+                m_pure[f.second] = pure;
+                if (!pure)
+                {
+                    impure.push_back (f.second);
+                }
+            }
+            while (!impure.empty ())
+            {
+                uint32_t f = impure.back ();
+                impure.pop_back ();
+                for (uint32_t caller : callers[f])
+                {
+                    if (m_pure[caller])
+                    {
+                        m_pure[caller] = false;
+                        impure.push_back (caller);
+                    }
+                }
+            }
+        }
+
+        Outcome
+        spend (size_t amount)
+        {
+            if (m_fuel < amount)
+            {
+                m_fuel = 0;
+                return OUT_OF_FUEL;
+            }
+            m_fuel -= amount;
+            return OK;
+        }
+
+        // Charges one node of fuel and one level of nesting; every enter
+        // is matched by a leave
+        Outcome
+        enter ()
+        {
+            ++m_nesting;
+            Outcome o = spend (1);
+            return o == OK && m_nesting > MAX_NESTING ? TOO_DEEP : o;
+        }
+
+        Outcome
+        leave (Outcome o)
+        {
+            --m_nesting;
+            return o;
+        }
+
+        // Evaluates id in frame; a NULL frame is the call site, where any
+        // variable makes the call not constant
+        Outcome
+        expr (uint32_t id, Frame* frame, Value& v)
+        {
+            Outcome o = enter ();
+            if (o != OK)
+            {
+                return leave (o);
+            }
+            const AstNode& n = node (id);
+            v.array = NULL;
+            switch (n.kind)
+            {
+                case AST_NUM:
+                    v.scalar = n.value;
+                    return leave (OK);
+
+                case AST_VAR:
+                {
+                    if (frame == NULL)
+                    {
+                        return leave (NOT_CONSTANT);
+                    }
+                    int d = declaration (n.token);
+                    std::unordered_map<int, std::vector<int64_t>*>::const_iterator a = frame->arrays.find (d);
+                    if (a != frame->arrays.end ())
+                    {
+                        v.array = a->second;
+                        return leave (OK);
+                    }
+                    std::unordered_map<int, int64_t>::const_iterator s = frame->scalars.find (d);
+                    if (s == frame->scalars.end () || s->second == UNSET)
+                    {
+                        return leave (FAILED);
+                    }
+                    v.scalar = s->second;
+                    return leave (OK);
+                }
+
+                case AST_SUBSCRIPT:
+                {
+                    int64_t* element;
+                    if ((o = subscript (id, frame, element)) != OK)
+                    {
+                        return leave (o);
+                    }
+                    if (*element == UNSET)
+                    {
+                        return leave (FAILED);
+                    }
+                    v.scalar = *element;
+                    return leave (OK);
+                }
+
+                case AST_ASSIGN:
+                {
+                    // The value is evaluated before the target, as in Cfg
+                    uint32_t target = child (id, 0);
+                    if ((o = scalar (child (id, 1), frame, v.scalar)) != OK)
+                    {
+                        return leave (o);
+                    }
+                    if (frame == NULL)
+                    {
+                        return leave (NOT_CONSTANT);
+                    }
+                    if (node (target).kind == AST_SUBSCRIPT)
+                    {
+                        int64_t* element;
+                        if ((o = subscript (target, frame, element)) != OK)
+                        {
+                            return leave (o);
+                        }
+                        *element = v.scalar;
+                        return leave (OK);
+                    }
+                    std::unordered_map<int, int64_t>::iterator s =
+                        frame->scalars.find (declaration (node (target).token));
+                    if (s == frame->scalars.end ())
+                    {
+                        return leave (FAILED);
+                    }
+                    s->second = v.scalar;
+                    return leave (OK);
+                }
+
+                case AST_BINARY:
+                {
+                    int64_t a;
+                    int64_t b;
+                    if ((o = scalar (child (id, 0), frame, a)) != OK ||
+                        (o = scalar (child (id, 1), frame, b)) != OK)
+                    {
+                        return leave (o);
+                    }
+                    switch (n.op)
+                    {
+                        case PLUS:  v.scalar = wrap (a + b); break;
+                        case MINUS: v.scalar = wrap (a - b); break;
+                        case TIMES: v.scalar = wrap (a * b); break;
+                        case DIVIDE:
+                            if (b == 0 || (a == INT32_MIN && b == -1))
+                            {
+                                return leave (FAILED);
+                            }
+                            v.scalar = a / b;
+                            break;
+                        case LT:    v.scalar = a < b; break;
+                        case LTE:   v.scalar = a <= b; break;
+                        case GT:    v.scalar = a > b; break;
+                        case GTE:   v.scalar = a >= b; break;
+                        case EQ:    v.scalar = a == b; break;
+                        case NEQ:   v.scalar = a != b; break;
+                        default:    return leave (FAILED);
+                    }
+                    return leave (OK);
+                }
+
+                case AST_CALL:
+                    return leave (call (id, frame, v.scalar));
+
+                default:
+                    return leave (FAILED);
+            }
+        }
+
+        Outcome
+        scalar (uint32_t id, Frame* frame, int64_t& value)
+        {
+            Value v;
+            Outcome o = expr (id, frame, v);
+            value = v.scalar;
+            return o == OK && v.array != NULL ? FAILED : o;
+        }
+
+        Outcome
+        subscript (uint32_t id, Frame* frame, int64_t*& element)
+        {
+            if (frame == NULL)
+            {
+                return NOT_CONSTANT;
+            }
+            int64_t index;
+            Outcome o = scalar (child (id, 0), frame, index);
+            if (o != OK)
+            {
+                return o;
+            }
+            std::unordered_map<int, std::vector<int64_t>*>::const_iterator a =
+                frame->arrays.find (declaration (node (id).token));
+            if (a == frame->arrays.end () || index < 0 || index >= (int64_t) a->second->size ())
+            {
+                return FAILED;
+            }
+            element = &(*a->second)[index];
+            return OK;
+        }
+
+        Outcome
+        call (uint32_t id, Frame* frame, int64_t& result)
+        {
+            int f = callee (id);
+            if (f < 0 || !m_pure[f])
+            {
+                return FAILED;
+            }
+            const AstNode& c = node (id);
+            const AstNode& fn = node (f);
+            std::vector<Value> args (c.childCount);
+            std::vector<int64_t> key (1, f);
+            bool scalars = true;
+            for (uint32_t k = 0; k < c.childCount; ++k)
+            {
+                Outcome o = expr (child (id, k), frame, args[k]);
+                if (o != OK)
+                {
+                    return o;
+                }
+                scalars = scalars && args[k].array == NULL;
+                key.push_back (args[k].scalar);
+            }
+            if (scalars)
+            {
+                std::map<std::vector<int64_t>, int64_t>::const_iterator known = m_results.find (key);
+                if (known != m_results.end ())
+                {
+                    result = known->second;
+                    return OK;
+                }
+            }
+            if (m_calls >= m_limits.depth)
+            {
+                return TOO_DEEP;
+            }
+
+            Frame inner;
+            uint32_t params = fn.childCount - 1;
+            if (params != c.childCount)
+            {
+                return FAILED;
+            }
+            for (uint32_t k = 0; k < params; ++k)
+            {
+                const AstNode& p = node (child (f, k));
+                if ((p.kind == AST_ARRAY_PARAM) != (args[k].array != NULL))
+                {
+                    return FAILED;
+                }
+                if (p.kind == AST_ARRAY_PARAM)
+                {
+                    inner.arrays[p.token] = args[k].array;
+                }
+                else
+                {
+                    inner.scalars[p.token] = args[k].scalar;
+                }
+            }
+            ++m_calls;
+            Outcome o = stmt (child (f, params), inner, result);
+            --m_calls;
+            if (o == OK)
+            {
+                // Fell off the end without a value
+                return FAILED;
+            }
+            if (o != RETURNED)
+            {
+                return o;
+            }
+            if (scalars)
+            {
+                m_results[key] = result;
+            }
+            return OK;
+        }
+
+        // OK to go on with the next statement, RETURNED with the value in
+        // result, or why evaluation stopped
+        Outcome
+        stmt (uint32_t id, Frame& frame, int64_t& result)
+        {
+            Outcome o = enter ();
+            if (o != OK)
+            {
+                return leave (o);
+            }
+            const AstNode& n = node (id);
+            switch (n.kind)
+            {
+                case AST_COMPOUND:
+                    for (uint32_t k = 0; k < n.childCount && o == OK; ++k)
+                    {
+                        uint32_t c = child (id, k);
+                        const AstNode& s = node (c);
+                        if (s.kind == AST_VAR_DECL)
+                        {
+                            frame.scalars[s.token] = UNSET;
+                        }
+                        else if (s.kind == AST_ARRAY_DECL)
+                        {
+                            if ((o = spend (s.value)) == OK)
+                            {
+                                frame.storage.emplace_back (s.value, UNSET);
+                                frame.arrays[s.token] = &frame.storage.back ();
+                            }
+                        }
+                        else
+                        {
+                            o = stmt (c, frame, result);
+                        }
+                    }
+                    return leave (o);
+
+                case AST_EXPR_STMT:
+                    if (n.childCount > 0)
+                    {
+                        Value v;
+                        o = expr (child (id, 0), &frame, v);
+                    }
+                    return leave (o);
+
+                case AST_IF:
+                {
+                    int64_t cond;
+                    if ((o = scalar (child (id, 0), &frame, cond)) != OK)
+                    {
+                        return leave (o);
+                    }
+                    if (cond != 0)
+                    {
+                        return leave (stmt (child (id, 1), frame, result));
+                    }
+                    return leave (n.childCount > 2 ? stmt (child (id, 2), frame, result) : OK);
+                }
+
+                case AST_WHILE:
+                    while (true)
+                    {
+                        int64_t cond;
+                        if ((o = scalar (child (id, 0), &frame, cond)) != OK || cond == 0 ||
+                            (o = stmt (child (id, 1), frame, result)) != OK ||
+                            (o = spend (1)) != OK)
+                        {
+                            return leave (o);
+                        }
+                    }
+
+                case AST_RETURN:
+                    if (n.childCount == 0)
+                    {
+                        return leave (FAILED);
+                    }
+                    o = scalar (child (id, 0), &frame, result);
+                    return leave (o == OK ? RETURNED : o);
+
+                default:
+                    return leave (FAILED);
+            }
+        }
+
+    private:
+        const Ast& m_ast;
+        SymbolTable m_symbols;
+        const ConstEvalLimits& m_limits;
+        std::vector<uint32_t> m_end;                    // end of each node's subtree
+        std::unordered_map<int, uint32_t> m_functions;  // by the token naming them
+        std::unordered_map<uint32_t, bool> m_pure;
+        std::map<std::vector<int64_t>, int64_t> m_results;  // callee, arguments
+
+        uint64_t m_fuel;
+        uint32_t m_calls;
+        uint32_t m_nesting;
+    };
+}
+
+/***********************/
+
+Ast
+foldConstantCalls (const Ast& ast, const std::vector<Token>& tokens, ConstEvalStats& stats,
+                   const ConstEvalLimits& limits)
+{
+    stats = ConstEvalStats { 0, 0, 0, 0, 0, 0, 0, 0 };
+    const std::vector<AstNode>& nodes = ast.nodes ();
+    if (nodes.empty ())
+    {
+        return ast;
+    }
+    Evaluator evaluator (ast, tokens, limits);
+    stats.pureFunctions = evaluator.pureCount ();
+
+    // Outermost calls first; a folded call's arguments are gone with it
+    std::unordered_map<uint32_t, int32_t> results;
+    for (uint32_t id = 0; id < nodes.size (); ++id)
+    {
+        if (nodes[id].kind != AST_CALL || !evaluator.candidate (id))
+        {
+            continue;
+        }
+        ++stats.sites;
+        int64_t result;
+        uint64_t steps;
+        switch (evaluator.fold (id, result, steps))
+        {
+            case OK:
+                ++stats.folded;
+                stats.steps += steps;
+                results[id] = result;
+                id = evaluator.end (id) - 1;
+                break;
+            case NOT_CONSTANT: ++stats.notConstant; break;
+            case OUT_OF_FUEL:  ++stats.outOfFuel; break;
+            case TOO_DEEP:     ++stats.tooDeep; break;
+            default:           ++stats.errors; break;
+        }
+    }
+    if (results.empty ())
+    {
+        return ast;
+    }
+
+    // Rebuilds bottom-up with an explicit stack, as deep as the tree is
+    Ast folded;
+    std::vector<std::pair<uint32_t, uint32_t>> stack (1, std::make_pair (0, 0));
+    while (!stack.empty ())
+    {
+        uint32_t id = stack.back ().first;
+        const AstNode& n = nodes[id];
+        std::unordered_map<uint32_t, int32_t>::const_iterator r = results.find (id);
+        if (r != results.end ())
+        {
+            folded.leaf (AST_NUM, 0, n.token, r->second);
+            stack.pop_back ();
+        }
+        else if (stack.back ().second < n.childCount)
+        {
+            uint32_t c = ast.child (id, stack.back ().second++);
+            stack.push_back (std::make_pair (c, 0));
+        }
+        else
+        {
+            folded.reduce ((AstKind) n.kind, n.op, n.token, n.childCount, n.value);
+            stack.pop_back ();
+        }
+    }
+    folded.finish ();
+    return folded;
+}
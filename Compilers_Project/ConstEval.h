@@ -0,0 +1,63 @@
+/*
+    Filename    : ConstEval.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Constant Evaluation
+*/
+
+/***********************/
+
+#ifndef CONST_EVAL_H
+#define CONST_EVAL_H
+
+/***********************/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Ast.h"
+#include "Lexer.h"
+
+/***********************/
+
+struct ConstEvalLimits
+{
+    uint64_t fuel = 1 << 20;    // nodes evaluated per call site
+    uint32_t depth = 256;       // calls in progress at once
+};
+
+struct ConstEvalStats
+{
+    uint32_t pureFunctions;
+    uint32_t sites;             // outermost calls to pure int functions
+    uint32_t folded;
+    uint32_t notConstant;       // an argument reads a variable
+    uint32_t outOfFuel;
+    uint32_t tooDeep;
+    uint32_t errors;            // divide by zero, subscript out of range,
+                                // unassigned read, no return value
+    uint64_t steps;             // fuel spent on the folded calls
+
+    std::string
+    report () const;
+};
+
+// Returns a copy of ast in which every call to a pure int function whose
+// arguments are constant is replaced by an AST_NUM holding its result
+// (the node keeps the call's token). A function is pure when it reads and
+// writes only its parameters and locals and calls only pure functions;
+// input and output, being undeclared, are not.
+//
+// Calls run in an evaluator with C-Minus int semantics: 32-bit, wrapping,
+// division truncating toward zero. Anything the evaluator cannot finish
+// within limits, or that would be an error at run time, is left as a
+// call. Results are cached by callee and arguments, so recursion such as
+// a naive Fibonacci costs each distinct call once.
+Ast
+foldConstantCalls (const Ast& ast, const std::vector<Token>& tokens, ConstEvalStats& stats,
+                   const ConstEvalLimits& limits = ConstEvalLimits ());
+
+/***********************/
+
+#endif
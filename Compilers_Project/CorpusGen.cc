@@ -0,0 +1,419 @@
+/*
+    Filename    : CorpusGen.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Benchmark Corpus
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/***********************/
+
+// Writes a random C-Minus program to stdout.
+//   usage: CorpusGen [--size=N[K|M|G]] [--depth=N] [--vocab=N]
+//                    [--comments=P] [--seed=N] [--invalid]
+//
+//   --size      stop after the function that reaches N bytes (default 1M)
+//   --depth     nesting of statements, and of one expression, on the
+//               deepest path through each function (8)
+//   --vocab     number of distinct identifiers to draw from (64)
+//   --comments  chance of a comment before each statement, 0 to 1 (0.05)
+//   --seed      random seed; the same options give the same file (1)
+//   --invalid   put one syntax error in a function near the middle
+//
+// Programs only use the grammar as written in CMinus.grammar, so both
+// Parser and LLParser accept them unless --invalid is given. Names and
+// types are not checked; nothing past the parser does that yet.
+
+/***********************/
+
+namespace
+{
+    // Nesting of statements and expressions off the deep spine
+    const int SHALLOW = 2;
+
+    struct Options
+    {
+        unsigned long long size = 1 << 20;
+        int depth = 8;
+        int vocab = 64;
+        double comments = 0.05;
+        unsigned seed = 1;
+        bool invalid = false;
+    };
+
+    class Generator
+    {
+    public:
+        Generator (const Options& options)
+            : m_options (options), m_random (options.seed), m_written (0), m_errorAt (0),
+              m_indent (0)
+        {
+            static const char* const KEYWORDS[] = { "if", "else", "int", "void", "return", "while" };
+            for (int i = 0; (int) m_names.size () < options.vocab; ++i)
+            {
+                std::string name = letters (i);
+                bool keyword = false;
+                for (const char* k : KEYWORDS)
+                {
+                    keyword = keyword || name == k;
+                }
+                if (!keyword)
+                {
+                    m_names.push_back (name);
+                }
+            }
+        }
+
+        void
+        run ()
+        {
+            m_errorAt = m_options.invalid ? m_options.size / 2 : 0;
+            for (int i = 0; i < 4 && i < m_options.vocab; ++i)
+            {
+                line ("int " + m_names[i] + (i % 2 ? "[100];" : ";"));
+            }
+            int functions = 0;
+            while (m_written < m_options.size || functions == 0)
+            {
+                function (functions++);
+            }
+            line ("void main (void)");
+            line ("{");
+            line ("    " + functionName (functions - 1) + " (1, " + m_names[1] + ");");
+            line ("}");
+        }
+
+    private:
+        // Identifiers are letters only: "a".."z", "aa", "ab", ...
+        static std::string
+        letters (int i)
+        {
+            std::string text;
+            for (int n = i; ; n = n / 26 - 1)
+            {
+                text.insert (text.begin (), 'a' + n % 26);
+                if (n < 26)
+                {
+                    return text;
+                }
+            }
+        }
+
+        // Functions are "Fa", "Fb", ..., which no variable name can be
+        static std::string
+        functionName (int i)
+        {
+            return "F" + letters (i);
+        }
+
+        int
+        pick (int n)
+        {
+            return std::uniform_int_distribution<int> (0, n - 1) (m_random);
+        }
+
+        bool
+        chance (double p)
+        {
+            return std::uniform_real_distribution<double> (0, 1) (m_random) < p;
+        }
+
+        const std::string&
+        name ()
+        {
+            return m_names[pick (m_names.size ())];
+        }
+
+        void
+        write (const std::string& text)
+        {
+            fwrite (text.data (), 1, text.size (), stdout);
+            m_written += text.size ();
+        }
+
+        void
+        line (const std::string& text)
+        {
+            // Indentation stops growing so deep nesting stays linear in size
+            write (std::string (std::min (m_indent, 16) * 4, ' ') + text + "\n");
+        }
+
+        void
+        comment ()
+        {
+            if (!chance (m_options.comments))
+            {
+                return;
+            }
+            if (chance (0.5))
+            {
+                line ("/* " + name () + " " + name () + " ** " + std::to_string (pick (1000)) + " */");
+                return;
+            }
+            line ("/*");
+            for (int i = pick (4) + 1; i > 0; --i)
+            {
+                line (" * " + name () + " = " + name () + " * 2; /");
+            }
+            line (" */");
+        }
+
+        std::string
+        var (int depth)
+        {
+            if (depth > 0 && chance (0.2))
+            {
+                return name () + "[" + expr (depth - 1) + "]";
+            }
+            return name ();
+        }
+
+        std::string
+        call (const std::string& firstArg)
+        {
+            std::string text = functionName (pick (m_functions + 1)) + " (" + firstArg;
+            return text + (chance (0.5) ? ", " + name () + ")" : ")");
+        }
+
+        std::string
+        factor (int depth)
+        {
+            int choice = depth > 0 ? pick (5) : pick (2);
+            switch (choice)
+            {
+                case 0:
+                    return std::to_string (pick (100000));
+                case 1:
+                    return name ();
+                case 2:
+                    return "(" + expr (depth - 1) + ")";
+                case 3:
+                    return var (depth);
+                default:
+                    return call (expr (depth - 1));
+            }
+        }
+
+        std::string
+        simpleExpr (int depth)
+        {
+            static const char* const MULOPS[] = { " * ", " / " };
+            static const char* const ADDOPS[] = { " + ", " - " };
+            static const char* const RELOPS[] = { " < ", " <= ", " > ", " >= ", " == ", " != " };
+            std::string text = factor (depth);
+            for (int i = pick (3); i > 0; --i)
+            {
+                text += (chance (0.5) ? MULOPS[pick (2)] : ADDOPS[pick (2)]) + factor (depth);
+            }
+            if (chance (0.2))
+            {
+                text += RELOPS[pick (6)] + factor (depth);
+            }
+            return text;
+        }
+
+        std::string
+        expr (int depth)
+        {
+            if (chance (0.15))
+            {
+                return var (depth) + " = " + simpleExpr (depth);
+            }
+            return simpleExpr (depth);
+        }
+
+        // One expression nested depth levels deep through parentheses,
+        // calls and assignments. Not through subscripts: Parser re-parses
+        // a subscripted var it rewinds over, which doubles per level.
+        std::string
+        deepExpr (int depth)
+        {
+            if (depth == 0)
+            {
+                return simpleExpr (0);
+            }
+            switch (pick (3))
+            {
+                case 0:
+                    return "(" + deepExpr (depth - 1) + ") * " + factor (0);
+                case 1:
+                    return call (deepExpr (depth - 1));
+                default:
+                    return name () + " = " + deepExpr (depth - 1);
+            }
+        }
+
+        // Nested statements form one spine per function that reaches the
+        // full depth; the statements around it nest at most SHALLOW deep,
+        // so output grows linearly with the depth
+        void
+        stmt (int depth, bool spine)
+        {
+            comment ();
+            if (m_errorAt > 0 && m_written >= m_errorAt)
+            {
+                // A call missing its closing parenthesis
+                line (name () + " = " + functionName (0) + " (" + simpleExpr (0) + ";");
+                m_errorAt = 0;
+                return;
+            }
+            if (spine && depth == 0)
+            {
+                line (name () + " = " + deepExpr (m_options.depth) + ";");
+                return;
+            }
+            int choice = spine ? 3 + pick (5) : depth > 0 ? pick (8) : pick (3);
+            switch (choice)
+            {
+                case 0:
+                case 1:
+                    line (var (SHALLOW) + " = " + expr (SHALLOW) + ";");
+                    break;
+                case 2:
+                    line (chance (0.5) ? "return " + expr (SHALLOW) + ";" : ";");
+                    break;
+                case 3:
+                case 4:
+                    line ("if (" + expr (SHALLOW) + ")");
+                    block (depth - 1, spine);
+                    if (chance (0.5))
+                    {
+                        line ("else");
+                        block (std::min (depth - 1, SHALLOW), false);
+                    }
+                    break;
+                case 5:
+                case 6:
+                    line ("while (" + expr (SHALLOW) + ")");
+                    block (depth - 1, spine);
+                    break;
+                default:
+                    block (depth - 1, spine);
+                    break;
+            }
+        }
+
+        void
+        block (int depth, bool spine)
+        {
+            line ("{");
+            ++m_indent;
+            for (int i = pick (3); i > 0; --i)
+            {
+                line ("int " + name () + (chance (0.2) ? "[" + std::to_string (pick (100) + 1) + "];" : ";"));
+            }
+            int count = pick (4) + 1;
+            int spineAt = pick (count);
+            for (int i = 0; i < count; ++i)
+            {
+                bool onSpine = spine && i == spineAt;
+                stmt (onSpine ? depth : std::min (depth, SHALLOW), onSpine);
+            }
+            --m_indent;
+            line ("}");
+        }
+
+        void
+        function (int index)
+        {
+            m_functions = index;
+            std::string header = (chance (0.5) ? "int " : "void ") + functionName (index) + " (";
+            int params = pick (4);
+            if (params == 0)
+            {
+                header += "void";
+            }
+            for (int i = 0; i < params; ++i)
+            {
+                header += "int " + name () + (chance (0.3) ? "[]" : "") + (i + 1 < params ? ", " : "");
+            }
+            comment ();
+            line (header + ")");
+            block (m_options.depth, true);
+            line ("");
+        }
+
+    private:
+        Options m_options;
+        std::mt19937_64 m_random;
+        std::vector<std::string> m_names;
+        unsigned long long m_written;
+        unsigned long long m_errorAt;
+        int m_indent;
+        int m_functions = 0;
+    };
+
+    unsigned long long
+    parseSize (const char* text)
+    {
+        char* end;
+        unsigned long long size = strtoull (text, &end, 10);
+        switch (*end)
+        {
+            case 'G': case 'g': size <<= 10; // fall through
+            case 'M': case 'm': size <<= 10; // fall through
+            case 'K': case 'k': size <<= 10;
+        }
+        return size;
+    }
+}
+
+/***********************/
+
+int
+main (int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg (argv[i]);
+        size_t eq = arg.find ('=');
+        std::string option = arg.substr (0, eq);
+        const char* value = eq == std::string::npos ? "" : argv[i] + eq + 1;
+        if (option == "--size")
+        {
+            options.size = parseSize (value);
+        }
+        else if (option == "--depth")
+        {
+            options.depth = atoi (value);
+        }
+        else if (option == "--vocab")
+        {
+            options.vocab = std::max (atoi (value), 4);
+        }
+        else if (option == "--comments")
+        {
+            options.comments = atof (value);
+        }
+        else if (option == "--seed")
+        {
+            options.seed = strtoul (value, NULL, 10);
+        }
+        else if (option == "--invalid")
+        {
+            options.invalid = true;
+        }
+        else
+        {
+            fprintf (stderr, "Unknown option: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    static char buffer[1 << 20];
+    setvbuf (stdout, buffer, _IOFBF, sizeof (buffer));
+    Generator gen (options);
+    gen.run ();
+    return fflush (stdout) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
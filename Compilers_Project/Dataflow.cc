@@ -0,0 +1,340 @@
+/*
+    Filename    : Dataflow.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Dataflow Analysis
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "Dataflow.h"
+#include "SymbolTable.h"
+
+/***********************/
+
+BitSet::BitSet (size_t size, bool value)
+    : m_size (size), m_words ((size + 63) / 64, value ? ~(uint64_t) 0 : 0)
+{
+    // Bits past size stay clear so whole-word compares work
+    if (value && size % 64 != 0)
+    {
+        m_words.back () = ((uint64_t) 1 << (size % 64)) - 1;
+    }
+}
+
+size_t
+BitSet::size () const
+{
+    return m_size;
+}
+
+bool
+BitSet::test (size_t i) const
+{
+    return (m_words[i / 64] >> (i % 64)) & 1;
+}
+
+void
+BitSet::set (size_t i)
+{
+    m_words[i / 64] |= (uint64_t) 1 << (i % 64);
+}
+
+void
+BitSet::reset (size_t i)
+{
+    m_words[i / 64] &= ~((uint64_t) 1 << (i % 64));
+}
+
+bool
+BitSet::transfer (const BitSet& in, const BitSet& gen, const BitSet& kill)
+{
+    uint64_t changed = 0;
+    for (size_t w = 0; w < m_words.size (); ++w)
+    {
+        uint64_t value = gen.m_words[w] | (in.m_words[w] & ~kill.m_words[w]);
+        changed |= value ^ m_words[w];
+        m_words[w] = value;
+    }
+    return changed != 0;
+}
+
+void
+BitSet::unionWith (const BitSet& other)
+{
+    for (size_t w = 0; w < m_words.size (); ++w)
+    {
+        m_words[w] |= other.m_words[w];
+    }
+}
+
+void
+BitSet::intersectWith (const BitSet& other)
+{
+    for (size_t w = 0; w < m_words.size (); ++w)
+    {
+        m_words[w] &= other.m_words[w];
+    }
+}
+
+bool
+BitSet::operator== (const BitSet& other) const
+{
+    return m_words == other.m_words;
+}
+
+/***********************/
+
+DataflowResult
+solveDataflow (const Cfg& cfg, const DataflowProblem& problem)
+{
+    auto begin = std::chrono::steady_clock::now ();
+    const std::vector<BasicBlock>& blocks = cfg.blocks ();
+    bool forward = problem.direction == DATAFLOW_FORWARD;
+    BitSet top (cfg.variableCount (), problem.meet == MEET_INTERSECTION);
+
+    DataflowResult result;
+    result.in.assign (blocks.size (), top);
+    result.out.assign (blocks.size (), top);
+    result.iterations = 0;
+
+    // The side of each block values flow into, and the side they leave by
+    std::vector<BitSet>& into = forward ? result.in : result.out;
+    std::vector<BitSet>& from = forward ? result.out : result.in;
+    uint32_t boundary = forward ? Cfg::ENTRY : Cfg::EXIT;
+
+    std::deque<uint32_t> worklist;
+    if (forward)
+    {
+        worklist.assign (cfg.order ().begin (), cfg.order ().end ());
+    }
+    else
+    {
+        worklist.assign (cfg.order ().rbegin (), cfg.order ().rend ());
+    }
+    std::vector<bool> queued (blocks.size (), true);
+
+    while (!worklist.empty ())
+    {
+        uint32_t b = worklist.front ();
+        worklist.pop_front ();
+        queued[b] = false;
+        ++result.iterations;
+
+        const std::vector<uint32_t>& sources = forward ? blocks[b].preds : blocks[b].succs;
+        if (b == boundary)
+        {
+            into[b] = problem.boundary;
+        }
+        else if (!sources.empty ())
+        {
+            into[b] = from[sources[0]];
+            for (size_t i = 1; i < sources.size (); ++i)
+            {
+                if (problem.meet == MEET_UNION)
+                {
+                    into[b].unionWith (from[sources[i]]);
+                }
+                else
+                {
+                    into[b].intersectWith (from[sources[i]]);
+                }
+            }
+        }
+
+        if (from[b].transfer (into[b], problem.gen[b], problem.kill[b]))
+        {
+            for (uint32_t next : forward ? blocks[b].succs : blocks[b].preds)
+            {
+                if (!queued[next])
+                {
+                    queued[next] = true;
+                    worklist.push_back (next);
+                }
+            }
+        }
+    }
+    result.seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ();
+    return result;
+}
+
+// gen is the variables read before any write in the block, kill those
+// written
+DataflowResult
+liveVariables (const Cfg& cfg)
+{
+    size_t bits = cfg.variableCount ();
+    DataflowProblem problem = { DATAFLOW_BACKWARD, MEET_UNION, BitSet (bits) };
+    problem.gen.assign (cfg.blocks ().size (), BitSet (bits));
+    problem.kill.assign (cfg.blocks ().size (), BitSet (bits));
+    for (size_t b = 0; b < cfg.blocks ().size (); ++b)
+    {
+        for (const CfgAccess& a : cfg.blocks ()[b].accesses)
+        {
+            if (a.def)
+            {
+                problem.kill[b].set (a.var);
+            }
+            else if (!problem.kill[b].test (a.var))
+            {
+                problem.gen[b].set (a.var);
+            }
+        }
+    }
+    return solveDataflow (cfg, problem);
+}
+
+// Arrays are never reported, so they start out assigned along with the
+// parameters
+DataflowResult
+definitelyAssigned (const Cfg& cfg)
+{
+    size_t bits = cfg.variableCount ();
+    DataflowProblem problem = { DATAFLOW_FORWARD, MEET_INTERSECTION, BitSet (bits) };
+    for (uint32_t v = 0; v < bits; ++v)
+    {
+        if (v < cfg.paramCount () || cfg.isArray (v))
+        {
+            problem.boundary.set (v);
+        }
+    }
+    problem.gen.assign (cfg.blocks ().size (), BitSet (bits));
+    problem.kill.assign (cfg.blocks ().size (), BitSet (bits));
+    for (size_t b = 0; b < cfg.blocks ().size (); ++b)
+    {
+        for (const CfgAccess& a : cfg.blocks ()[b].accesses)
+        {
+            if (a.def)
+            {
+                problem.gen[b].set (a.var);
+            }
+        }
+    }
+    return solveDataflow (cfg, problem);
+}
+
+/***********************/
+
+namespace
+{
+    typedef std::vector<std::pair<uint32_t, std::string>> Found;
+
+    void
+    functionWarnings (const Ast& ast, const std::vector<Token>& tokens, SymbolTable& symbols,
+                      uint32_t function, Found& found, DataflowStats& stats)
+    {
+        Cfg cfg (ast, symbols, function);
+        DataflowResult assigned = definitelyAssigned (cfg);
+        DataflowResult live = liveVariables (cfg);
+        stats.functions = 1;
+        stats.blocks = cfg.blocks ().size ();
+        stats.variables = cfg.variableCount ();
+        stats.iterations = assigned.iterations + live.iterations;
+        stats.seconds = assigned.seconds + live.seconds;
+
+        for (size_t b = 0; b < cfg.blocks ().size (); ++b)
+        {
+            const std::vector<CfgAccess>& accesses = cfg.blocks ()[b].accesses;
+            BitSet current = assigned.in[b];
+            for (const CfgAccess& a : accesses)
+            {
+                if (a.def)
+                {
+                    current.set (a.var);
+                }
+                else if (!current.test (a.var))
+                {
+                    found.push_back (std::make_pair (a.token, "'" + tokens[a.token].lexeme +
+                                                     "' may be used before it is assigned"));
+                }
+            }
+
+            current = live.out[b];
+            for (size_t i = accesses.size (); i-- > 0; )
+            {
+                const CfgAccess& a = accesses[i];
+                if (!a.def)
+                {
+                    current.set (a.var);
+                    continue;
+                }
+                if (!current.test (a.var))
+                {
+                    found.push_back (std::make_pair (a.token, "value assigned to '" +
+                                                     tokens[a.token].lexeme + "' is never used"));
+                }
+                current.reset (a.var);
+            }
+        }
+        std::sort (found.begin (), found.end ());
+    }
+}
+
+std::vector<std::string>
+dataflowWarnings (const Ast& ast, const std::vector<Token>& tokens, DataflowStats& stats,
+                  WorkStealingPool* pool)
+{
+    stats = DataflowStats { 0, 0, 0, 0, 0 };
+    if (ast.nodes ().empty ())
+    {
+        return std::vector<std::string> ();
+    }
+    SymbolTable symbols (tokens);
+    std::vector<uint32_t> functions;
+    const AstNode& program = ast.nodes ()[0];
+    for (uint32_t k = 0; k < program.childCount; ++k)
+    {
+        if (ast.nodes ()[ast.child (0, k)].kind == AST_FUN_DECL)
+        {
+            functions.push_back (ast.child (0, k));
+        }
+    }
+
+    // Functions cover disjoint, increasing token ranges, so their sorted
+    // warnings concatenate into source order however they were scheduled
+    std::vector<Found> found (functions.size ());
+    std::vector<DataflowStats> functionStats (functions.size ());
+    std::function<void (size_t)> task = [&] (size_t i) {
+        functionWarnings (ast, tokens, symbols, functions[i], found[i], functionStats[i]);
+    };
+    if (pool != NULL)
+    {
+        pool->run (functions.size (), task);
+    }
+    else
+    {
+        for (size_t i = 0; i < functions.size (); ++i)
+        {
+            task (i);
+        }
+    }
+
+    std::vector<std::string> warnings;
+    for (size_t i = 0; i < functions.size (); ++i)
+    {
+        stats.functions += functionStats[i].functions;
+        stats.blocks += functionStats[i].blocks;
+        stats.variables += functionStats[i].variables;
+        stats.iterations += functionStats[i].iterations;
+        stats.seconds += functionStats[i].seconds;
+        for (const std::pair<uint32_t, std::string>& f : found[i])
+        {
+            char position[64];
+            snprintf (position, sizeof (position), " (line %d, column %d)", tokens[f.first].line,
+                      tokens[f.first].column);
+            warnings.push_back ("warning: " + f.second + position);
+        }
+    }
+    return warnings;
+}
@@ -0,0 +1,133 @@
+/*
+    Filename    : Dataflow.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Dataflow Analysis
+*/
+
+/***********************/
+
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+/***********************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Ast.h"
+#include "Cfg.h"
+#include "Lexer.h"
+#include "WorkStealingPool.h"
+
+/***********************/
+
+// Fixed-size set of small integers, 64 per word. The operations the
+// solver runs per block work a word at a time.
+class BitSet
+{
+public:
+    BitSet (size_t size = 0, bool value = false);
+
+    size_t
+    size () const;
+
+    bool
+    test (size_t i) const;
+
+    void
+    set (size_t i);
+
+    void
+    reset (size_t i);
+
+    // *this = gen | (in & ~kill); true if that changed *this
+    bool
+    transfer (const BitSet& in, const BitSet& gen, const BitSet& kill);
+
+    void
+    unionWith (const BitSet& other);
+
+    void
+    intersectWith (const BitSet& other);
+
+    bool
+    operator== (const BitSet& other) const;
+
+private:
+    size_t m_size;
+    std::vector<uint64_t> m_words;
+};
+
+/***********************/
+
+enum DataflowDirection
+{
+    DATAFLOW_FORWARD, DATAFLOW_BACKWARD
+};
+
+enum DataflowMeet
+{
+    MEET_UNION, MEET_INTERSECTION
+};
+
+// A gen/kill problem over a Cfg's variables. boundary is the value
+// flowing into the entry (forward) or out of the exit (backward).
+struct DataflowProblem
+{
+    DataflowDirection direction;
+    DataflowMeet meet;
+    BitSet boundary;
+    std::vector<BitSet> gen;
+    std::vector<BitSet> kill;
+};
+
+// in and out are the values at the start and end of each block, whichever
+// way the problem flows. iterations counts block transfers.
+struct DataflowResult
+{
+    std::vector<BitSet> in;
+    std::vector<BitSet> out;
+    uint64_t iterations;
+    double seconds;
+};
+
+// Iterates to the fixed point with a worklist seeded in reverse postorder
+// (postorder for backward problems), so acyclic code settles in one pass
+DataflowResult
+solveDataflow (const Cfg& cfg, const DataflowProblem& problem);
+
+// Variables whose current value may still be read
+DataflowResult
+liveVariables (const Cfg& cfg);
+
+// Variables assigned on every path from the entry; parameters count as
+// assigned
+DataflowResult
+definitelyAssigned (const Cfg& cfg);
+
+/***********************/
+
+struct DataflowStats
+{
+    uint32_t functions;
+    uint64_t blocks;
+    uint64_t variables;
+    uint64_t iterations;
+    double seconds;         // in the solver
+};
+
+// Runs both analyses on every function and returns, in source order, a
+// warning for each read of a scalar local that may not have been assigned
+// yet and each assignment to one whose value is never read. With a pool,
+// each function is a task; the warnings come out the same either way.
+// stats.seconds then adds up the solver time of every thread.
+std::vector<std::string>
+dataflowWarnings (const Ast& ast, const std::vector<Token>& tokens, DataflowStats& stats,
+                  WorkStealingPool* pool = NULL);
+
+/***********************/
+
+#endif
@@ -0,0 +1,101 @@
+/*
+    Filename    : DataflowBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Dataflow Analysis
+*/
+
+/***********************/
+// System includes
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/***********************/
+// Local includes
+
+#include "Ast.h"
+#include "Cfg.h"
+#include "Dataflow.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SymbolTable.h"
+
+/***********************/
+
+// How the dataflow solver scales with function size. Each size n is one
+// function with n locals and n loops, each loop reading and writing a few
+// locals chosen at random, so there are about 4n blocks and every bit set
+// is n bits wide. Prints the blocks, the block visits each analysis took
+// to converge, and the solver time.
+//   usage: DataflowBench [largest n]
+
+/***********************/
+
+static std::string
+name (unsigned i)
+{
+    std::string text;
+    for (unsigned n = i; ; n = n / 26 - 1)
+    {
+        text.insert (text.begin (), 'a' + n % 26);
+        if (n < 26)
+        {
+            return "x" + text;
+        }
+    }
+}
+
+static std::string
+program (unsigned n)
+{
+    unsigned seed = 12345;
+    auto pick = [&seed, n] () {
+        seed = seed * 1103515245 + 12345;
+        return name ((seed >> 8) % n);
+    };
+    std::string text = "int f (int p)\n{\n";
+    for (unsigned i = 0; i < n; ++i)
+    {
+        text += "    int " + name (i) + ";\n";
+    }
+    for (unsigned i = 0; i < n; ++i)
+    {
+        std::string a = pick ();
+        text += "    while (" + a + " < " + pick () + ")\n    {\n";
+        text += "        " + a + " = " + a + " + " + pick () + ";\n";
+        text += "        if (" + pick () + " > p) " + pick () + " = " + a + ";\n    }\n";
+    }
+    return text + "    return " + pick () + ";\n}\n";
+}
+
+int
+main (int argc, char* argv[])
+{
+    unsigned largest = argc > 1 ? atoi (argv[1]) : 4096;
+    printf ("%8s %8s %14s %14s %10s\n", "locals", "blocks", "live visits", "assign visits",
+            "solver ms");
+    for (unsigned n = 256; n <= largest; n *= 4)
+    {
+        std::string source = program (n);
+        Lexer lex (source.data (), source.size ());
+        Parser pars (lex.tokenize ());
+        Ast ast;
+        std::string message = pars.parse (ast);
+        if (!message.empty ())
+        {
+            fprintf (stderr, "generated program rejected:%s", message.c_str ());
+            return EXIT_FAILURE;
+        }
+        SymbolTable symbols (pars.m_tokens);
+        Cfg cfg (ast, symbols, ast.child (0, 0));
+        DataflowResult live = liveVariables (cfg);
+        DataflowResult assigned = definitelyAssigned (cfg);
+        printf ("%8u %8zu %14llu %14llu %10.2f\n", cfg.variableCount (), cfg.blocks ().size (),
+                (unsigned long long) live.iterations, (unsigned long long) assigned.iterations,
+                (live.seconds + assigned.seconds) * 1e3);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+/*
+    Filename    : FlexScanner.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Lexer Engines
+*/
+
+/***********************/
+
+#ifndef FLEX_SCANNER_H
+#define FLEX_SCANNER_H
+
+/***********************/
+
+#include <cstdio>
+#include <vector>
+
+#include "Lexer.h"
+
+/***********************/
+
+// The flex scanner in Lexer.l behind the TokenSource interface. It is a
+// reentrant scanner, so several can run at once, and it reproduces the
+// hand-written Lexer's tokens exactly: the same lexemes, line and column
+// conventions, offsets, and END_OF_FILE at an unterminated comment.
+// Only built where flex is installed (HAVE_FLEX); make check-lexers
+// compares the two engines token for token.
+class FlexScanner final : public TokenSource
+{
+public:
+    // Takes ownership of srcFile, as Lexer does
+    FlexScanner (FILE* srcFile);
+
+    ~FlexScanner ();
+
+    Token
+    getToken () override;
+
+    std::vector<Token>
+    tokenize () override;
+
+    void
+    tokenize (TokenQueue& queue) override;
+
+    // Position bookkeeping shared with the rule actions in Lexer.l
+    struct State
+    {
+        int line;
+        int column;
+        int offset;
+        int commentStart;
+        Token token;
+    };
+
+private:
+    FILE* m_srcFile;
+    void* m_scanner;        // yyscan_t
+    State m_state;
+};
+
+/***********************/
+
+#endif
@@ -0,0 +1,139 @@
+/*
+    Filename    : FrameArena.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Interpreter
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+/***********************/
+// Local includes
+
+#include "FrameArena.h"
+
+/***********************/
+
+static const size_t FIRST_BLOCK_BYTES = 64 * 1024;
+static const size_t MAX_BLOCK_BYTES = 64 * 1024 * 1024;
+static const size_t ALIGNMENT = 16;
+
+/***********************/
+
+FrameArena::FrameArena (size_t limit)
+    : m_block (0), m_offset (0), m_used (0), m_highWater (0), m_reserved (0), m_limit (limit)
+{
+}
+
+FrameArena::~FrameArena ()
+{
+    for (Block& b : m_blocks)
+    {
+        free (b.data);
+    }
+}
+
+void*
+FrameArena::push (size_t bytes)
+{
+    bytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (m_blocks.empty () || m_offset + bytes > m_blocks[m_block].size)
+    {
+        // On to the next block, replacing it if it is too small. The
+        // limit counts the blocks, so a new block is no larger than what
+        // it still allows once the one replaced is freed.
+        size_t next = m_blocks.empty () ? 0 : m_block + 1;
+        if (next == m_blocks.size () || m_blocks[next].size < bytes)
+        {
+            size_t replaced = next == m_blocks.size () ? 0 : m_blocks[next].size;
+            size_t allowed = m_limit - (m_reserved - replaced);
+            if (bytes > allowed)
+            {
+                return NULL;
+            }
+            size_t size = next == 0 ? FIRST_BLOCK_BYTES
+                                    : std::min (m_blocks[next - 1].size * 2, MAX_BLOCK_BYTES);
+            size = std::max (std::min (size, allowed), bytes);
+            Block b = { (char*) malloc (size), size };
+            if (b.data == NULL)
+            {
+                return NULL;
+            }
+            if (next == m_blocks.size ())
+            {
+                m_blocks.push_back (b);
+            }
+            else
+            {
+                free (m_blocks[next].data);
+                m_blocks[next] = b;
+            }
+            m_reserved += size - replaced;
+        }
+        m_block = next;
+        m_offset = 0;
+    }
+    char* frame = m_blocks[m_block].data + m_offset;
+    memset (frame, 0, bytes);
+    m_offset += bytes;
+    m_used += bytes;
+    m_highWater = std::max (m_highWater, m_used);
+    return frame;
+}
+
+FrameArena::Mark
+FrameArena::mark () const
+{
+    Mark m = { m_block, m_offset, m_used };
+    return m;
+}
+
+void
+FrameArena::pop (const Mark& m)
+{
+    m_block = m.block;
+    m_offset = m.offset;
+    m_used = m.used;
+}
+
+void
+FrameArena::reset (size_t limit)
+{
+    m_block = 0;
+    m_offset = 0;
+    m_used = 0;
+    m_highWater = 0;
+    m_limit = limit;
+    if (m_reserved > m_limit)
+    {
+        for (Block& b : m_blocks)
+        {
+            free (b.data);
+        }
+        m_blocks.clear ();
+        m_reserved = 0;
+    }
+}
+
+size_t
+FrameArena::used () const
+{
+    return m_used;
+}
+
+size_t
+FrameArena::highWater () const
+{
+    return m_highWater;
+}
+
+size_t
+FrameArena::reserved () const
+{
+    return m_reserved;
+}
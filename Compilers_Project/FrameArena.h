@@ -0,0 +1,97 @@
+/*
+    Filename    : FrameArena.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Interpreter
+*/
+
+/***********************/
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+/***********************/
+
+#include <cstddef>
+#include <vector>
+
+/***********************/
+
+// A stack of activation records. Frames are carved out of large blocks
+// one after another, so a call and its callees sit next to each other in
+// memory, and popping a frame is resetting an offset. Blocks double in
+// size as the stack deepens; a frame never spans two blocks and never
+// moves, so pointers into it stay valid until it is popped. Blocks are
+// kept after the stack shrinks, so a call that repeatedly crosses a block
+// boundary does not allocate.
+//
+// The limit counts the blocks, not just the frames in them, so it bounds
+// the memory the arena takes from the system; the unused tail of a block
+// counts too.
+class FrameArena
+{
+public:
+    struct Mark
+    {
+        size_t block;
+        size_t offset;
+        size_t used;
+    };
+
+    // At most limit bytes of blocks may be allocated at once
+    FrameArena (size_t limit);
+
+    FrameArena (const FrameArena&) = delete;
+
+    FrameArena&
+    operator= (const FrameArena&) = delete;
+
+    ~FrameArena ();
+
+    // bytes of zeroed memory, 16-byte aligned, or NULL if that would
+    // exceed the limit
+    void*
+    push (size_t bytes);
+
+    Mark
+    mark () const;
+
+    // Frees every frame pushed since m
+    void
+    pop (const Mark& m);
+
+    // Frees every frame, forgets the high-water mark and sets a new
+    // limit; keeps the blocks unless together they exceed it
+    void
+    reset (size_t limit);
+
+    // Bytes of frames live now, and the most there have been since reset
+    size_t
+    used () const;
+
+    size_t
+    highWater () const;
+
+    // Bytes of blocks allocated
+    size_t
+    reserved () const;
+
+private:
+    struct Block
+    {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_block;
+    size_t m_offset;
+    size_t m_used;
+    size_t m_highWater;
+    size_t m_reserved;
+    size_t m_limit;
+};
+
+/***********************/
+
+#endif
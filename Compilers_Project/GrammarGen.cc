@@ -0,0 +1,425 @@
+/*
+    Filename    : GrammarGen.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Table-Driven Parser
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/***********************/
+// Local includes
+
+#include "Lexer.h"
+
+/***********************/
+
+// Reads a grammar (see CMinus.grammar), computes FIRST and FOLLOW sets,
+// builds the LL(1) table and writes it as a C++ header for LLParser.
+//   usage: GrammarGen grammar-file > LLTable.h
+// Fails if a nonterminal is never defined or the number of conflicts is
+// not what %expect says.
+
+/***********************/
+
+static const int TERMINALS = NUM + 1;
+
+typedef std::bitset<TERMINALS> TokenSet;
+
+struct TokenName
+{
+    TokenType type;
+    const char* name;
+    const char* lexeme;
+};
+
+static const TokenName TOKEN_NAMES[] = {
+    { END_OF_FILE, "END_OF_FILE", NULL }, { ERROR, "ERROR", NULL },
+    { IF, "IF", "if" }, { ELSE, "ELSE", "else" }, { INT, "INT", "int" },
+    { VOID, "VOID", "void" }, { RETURN, "RETURN", "return" }, { WHILE, "WHILE", "while" },
+    { PLUS, "PLUS", "+" }, { MINUS, "MINUS", "-" }, { TIMES, "TIMES", "*" },
+    { DIVIDE, "DIVIDE", "/" }, { LT, "LT", "<" }, { LTE, "LTE", "<=" },
+    { GT, "GT", ">" }, { GTE, "GTE", ">=" }, { EQ, "EQ", "==" }, { NEQ, "NEQ", "!=" },
+    { ASSIGN, "ASSIGN", "=" }, { SEMI, "SEMI", ";" }, { COMMA, "COMMA", "," },
+    { LPAREN, "LPAREN", "(" }, { RPAREN, "RPAREN", ")" }, { LBRACK, "LBRACK", "[" },
+    { RBRACK, "RBRACK", "]" }, { LBRACE, "LBRACE", "{" }, { RBRACE, "RBRACE", "}" },
+    { ID, "ID", NULL }, { NUM, "NUM", NULL }
+};
+
+// Symbols below TERMINALS are TokenTypes; nonterminal n is TERMINALS + n
+struct Production
+{
+    int lhs;
+    std::vector<int> rhs;
+};
+
+static std::vector<std::string> s_nonterminals;
+static std::map<std::string, int> s_nonterminalIndex;
+static std::vector<bool> s_defined;
+static std::vector<Production> s_productions;
+static int s_expect = 0;
+
+/***********************/
+
+static void
+fail (int line, const std::string& message)
+{
+    fprintf (stderr, "GrammarGen: line %d: %s\n", line, message.c_str ());
+    exit (EXIT_FAILURE);
+}
+
+static int
+nonterminal (const std::string& name)
+{
+    std::map<std::string, int>::iterator found = s_nonterminalIndex.find (name);
+    if (found != s_nonterminalIndex.end ())
+    {
+        return found->second;
+    }
+    s_nonterminals.push_back (name);
+    s_defined.push_back (false);
+    return s_nonterminalIndex[name] = s_nonterminals.size () - 1;
+}
+
+static int
+symbol (const std::string& word, int line)
+{
+    if (word[0] == '\'')
+    {
+        std::string lexeme = word.substr (1, word.size () - 2);
+        for (const TokenName& t : TOKEN_NAMES)
+        {
+            if (t.lexeme != NULL && lexeme == t.lexeme)
+            {
+                return t.type;
+            }
+        }
+        fail (line, "unknown lexeme " + word);
+    }
+    if (islower (word[0]))
+    {
+        return TERMINALS + nonterminal (word);
+    }
+    for (const TokenName& t : TOKEN_NAMES)
+    {
+        if (word == t.name)
+        {
+            return t.type;
+        }
+    }
+    fail (line, "unknown token " + word);
+    return -1;
+}
+
+static void
+readGrammar (const char* path)
+{
+    std::ifstream in (path);
+    if (!in)
+    {
+        perror (path);
+        exit (EXIT_FAILURE);
+    }
+    std::string text;
+    int lineNum = 0;
+    int lhs = -1;
+    while (std::getline (in, text))
+    {
+        ++lineNum;
+        std::istringstream words (text);
+        std::string word;
+        if (!(words >> word) || word[0] == '#')
+        {
+            continue;
+        }
+        if (word == "%expect")
+        {
+            words >> s_expect;
+            continue;
+        }
+        if (word != "|")
+        {
+            std::string arrow;
+            if (!(words >> arrow) || arrow != "->" || !islower (word[0]))
+            {
+                fail (lineNum, "expected 'nonterminal ->'");
+            }
+            lhs = nonterminal (word);
+            s_defined[lhs] = true;
+        }
+        else if (lhs < 0)
+        {
+            fail (lineNum, "'|' before any rule");
+        }
+
+        Production p = { lhs, std::vector<int> () };
+        while (words >> word)
+        {
+            if (word == "|")
+            {
+                s_productions.push_back (p);
+                p.rhs.clear ();
+            }
+            else if (word != "%empty")
+            {
+                p.rhs.push_back (symbol (word, lineNum));
+            }
+        }
+        s_productions.push_back (p);
+    }
+    for (size_t n = 0; n < s_nonterminals.size (); ++n)
+    {
+        if (!s_defined[n])
+        {
+            fail (lineNum, "nonterminal " + s_nonterminals[n] + " is never defined");
+        }
+    }
+}
+
+/***********************/
+
+static std::vector<bool> s_nullable;
+static std::vector<TokenSet> s_first;
+static std::vector<TokenSet> s_follow;
+
+// FIRST of rhs[from..]; sets nullable if all of it can be empty
+static TokenSet
+firstOf (const std::vector<int>& rhs, size_t from, bool& nullable)
+{
+    TokenSet set;
+    for (size_t i = from; i < rhs.size (); ++i)
+    {
+        if (rhs[i] < TERMINALS)
+        {
+            set.set (rhs[i]);
+            nullable = false;
+            return set;
+        }
+        int n = rhs[i] - TERMINALS;
+        set |= s_first[n];
+        if (!s_nullable[n])
+        {
+            nullable = false;
+            return set;
+        }
+    }
+    nullable = true;
+    return set;
+}
+
+static void
+computeSets ()
+{
+    size_t count = s_nonterminals.size ();
+    s_nullable.assign (count, false);
+    s_first.assign (count, TokenSet ());
+    s_follow.assign (count, TokenSet ());
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const Production& p : s_productions)
+        {
+            bool nullable;
+            TokenSet first = firstOf (p.rhs, 0, nullable);
+            if ((s_first[p.lhs] | first) != s_first[p.lhs])
+            {
+                s_first[p.lhs] |= first;
+                changed = true;
+            }
+            if (nullable && !s_nullable[p.lhs])
+            {
+                s_nullable[p.lhs] = true;
+                changed = true;
+            }
+        }
+    }
+
+    // The start symbol ends in END_OF_FILE, so it needs no follow set
+    changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const Production& p : s_productions)
+        {
+            for (size_t i = 0; i < p.rhs.size (); ++i)
+            {
+                if (p.rhs[i] < TERMINALS)
+                {
+                    continue;
+                }
+                int n = p.rhs[i] - TERMINALS;
+                bool nullable;
+                TokenSet follow = firstOf (p.rhs, i + 1, nullable);
+                if (nullable)
+                {
+                    follow |= s_follow[p.lhs];
+                }
+                if ((s_follow[n] | follow) != s_follow[n])
+                {
+                    s_follow[n] |= follow;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+/***********************/
+
+int
+main (int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        fprintf (stderr, "usage: %s grammar-file\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    readGrammar (argv[1]);
+    computeSets ();
+
+    // table[n][t] is production + 1, or 0 for a syntax error
+    size_t count = s_nonterminals.size ();
+    std::vector<std::vector<int>> table (count, std::vector<int> (TERMINALS, 0));
+    std::vector<std::string> conflicts;
+    for (size_t i = 0; i < s_productions.size (); ++i)
+    {
+        const Production& p = s_productions[i];
+        bool nullable;
+        TokenSet select = firstOf (p.rhs, 0, nullable);
+        if (nullable)
+        {
+            select |= s_follow[p.lhs];
+        }
+        for (int t = 0; t < TERMINALS; ++t)
+        {
+            if (!select[t])
+            {
+                continue;
+            }
+            int& cell = table[p.lhs][t];
+            if (cell != 0)
+            {
+                conflicts.push_back (s_nonterminals[p.lhs] + " on " + TOKEN_NAMES[t].name);
+                continue;
+            }
+            cell = i + 1;
+        }
+    }
+    if ((int) conflicts.size () != s_expect)
+    {
+        for (const std::string& c : conflicts)
+        {
+            fprintf (stderr, "GrammarGen: conflict in %s\n", c.c_str ());
+        }
+        fprintf (stderr, "GrammarGen: %zu conflicts, expected %d\n", conflicts.size (), s_expect);
+        return EXIT_FAILURE;
+    }
+    if (s_productions.size () >= 255)
+    {
+        fprintf (stderr, "GrammarGen: too many productions for an 8-bit table\n");
+        return EXIT_FAILURE;
+    }
+
+    printf ("// Generated by GrammarGen from %s; do not edit.\n\n", argv[1]);
+    printf ("#ifndef LL_TABLE_H\n#define LL_TABLE_H\n\n");
+    printf ("#include \"Lexer.h\"\n\n");
+    printf ("static const int LL_TERMINALS = %d;\n\n", TERMINALS);
+    printf ("// Nonterminals are numbered after the TokenTypes\n");
+    printf ("enum LLNonterminal\n{\n");
+    for (size_t n = 0; n < count; ++n)
+    {
+        printf ("    LL_%s%s,\n", s_nonterminals[n].c_str (), n == 0 ? " = LL_TERMINALS" : "");
+    }
+    printf ("    LL_SYMBOLS\n};\n\n");
+    printf ("static const int LL_START = LL_%s;\n\n",
+            s_nonterminals[s_productions[0].lhs].c_str ());
+
+    printf ("static const char* const LL_NAMES[] = {\n");
+    for (size_t n = 0; n < count; ++n)
+    {
+        printf ("    \"%s\",\n", s_nonterminals[n].c_str ());
+    }
+    printf ("};\n\n");
+
+    // The token reported as expected when a nonterminal cannot start
+    printf ("static const TokenType LL_EXPECTED[] = {\n");
+    for (size_t n = 0; n < count; ++n)
+    {
+        int t = 0;
+        while (t < TERMINALS - 1 && !s_first[n][t])
+        {
+            ++t;
+        }
+        printf ("    %s,\n", TOKEN_NAMES[t].name);
+    }
+    printf ("};\n\n");
+
+    // Right-hand sides are stored reversed, ready to push
+    printf ("static const short LL_RHS[] = {\n");
+    std::vector<int> starts;
+    int offset = 0;
+    for (const Production& p : s_productions)
+    {
+        starts.push_back (offset);
+        printf ("    /* %s -> */", s_nonterminals[p.lhs].c_str ());
+        for (size_t i = p.rhs.size (); i-- > 0; )
+        {
+            int sym = p.rhs[i];
+            if (sym < TERMINALS)
+            {
+                printf (" %s,", TOKEN_NAMES[sym].name);
+            }
+            else
+            {
+                printf (" LL_%s,", s_nonterminals[sym - TERMINALS].c_str ());
+            }
+        }
+        printf ("\n");
+        offset += p.rhs.size ();
+    }
+    starts.push_back (offset);
+    printf ("    -1\n};\n\n");
+
+    size_t longest = 0;
+    for (const Production& p : s_productions)
+    {
+        longest = std::max (longest, p.rhs.size ());
+    }
+    printf ("static const int LL_MAX_RHS = %zu;\n\n", longest);
+
+    printf ("// Production p pushes LL_RHS[LL_RHS_START[p] .. LL_RHS_START[p + 1])\n");
+    printf ("static const short LL_RHS_START[] = {");
+    for (size_t i = 0; i < starts.size (); ++i)
+    {
+        printf ("%s%d,", i % 16 == 0 ? "\n    " : " ", starts[i]);
+    }
+    printf ("\n};\n\n");
+
+    printf ("// LL_TABLE[nonterminal][token] is production + 1, or 0 for an error\n");
+    printf ("static const unsigned char LL_TABLE[][LL_TERMINALS] = {\n");
+    for (size_t n = 0; n < count; ++n)
+    {
+        printf ("    /* %-17s */ {", s_nonterminals[n].c_str ());
+        for (int t = 0; t < TERMINALS; ++t)
+        {
+            printf ("%s%d", t ? "," : "", table[n][t]);
+        }
+        printf ("},\n");
+    }
+    printf ("};\n\n#endif\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+/*
+    Filename    : IncrementalBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Incremental Parsing
+*/
+
+/***********************/
+// System includes
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+/***********************/
+// Local includes
+
+#include "BenchClock.h"
+#include "IncrementalParser.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+/***********************/
+
+// Applies random small edits to a source through IncrementalParser and
+// compares the cost with lexing and parsing the whole edited source. The
+// first CHECKED edits are also verified against a full lex and parse.
+//   usage: IncrementalBench file.cm [edits]
+
+/***********************/
+
+static const int CHECKED = 300;
+
+// What CMinus prints for text, minus "Valid!"
+static std::string
+fullParse (const std::string& text, std::vector<Token>& tokens)
+{
+    Lexer lex (text.data (), text.size ());
+    tokens = lex.tokenize ();
+    Parser pars (tokens);
+    try
+    {
+        pars.program ();
+    }
+    catch (const ParseError& e)
+    {
+        return pars.describe (e);
+    }
+    return "";
+}
+
+static bool
+sameTokens (const std::vector<Token>& a, const std::vector<Token>& b)
+{
+    if (a.size () != b.size ())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size (); ++i)
+    {
+        if (a[i].type != b[i].type || a[i].lexeme != b[i].lexeme ||
+            a[i].line != b[i].line || a[i].column != b[i].column ||
+            a[i].offset != b[i].offset)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int
+main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s file.cm [edits]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int edits = argc > 2 ? atoi (argv[2]) : 2000;
+
+    std::string text;
+    FILE* srcFile = fopen (argv[1], "r");
+    if (srcFile == NULL)
+    {
+        perror (argv[1]);
+        return EXIT_FAILURE;
+    }
+    char buffer[1 << 16];
+    size_t n;
+    while ((n = fread (buffer, 1, sizeof (buffer), srcFile)) > 0)
+    {
+        text.append (buffer, n);
+    }
+    fclose (srcFile);
+
+    IncrementalParser inc (text);
+    std::vector<Token> tokens;
+    auto begin = std::chrono::steady_clock::now ();
+    fullParse (text, tokens);
+    double full = seconds (begin);
+
+    // Edits favour characters that split, join or comment out tokens
+    static const char* const PIECES[] = {
+        " ", "\n", "x", "1", ";", "(", ")", "{", "}", "=", "<", "/", "*", "/*", "*/", "int "
+    };
+    const int pieceCount = sizeof (PIECES) / sizeof (PIECES[0]);
+    std::mt19937 random (435);
+    double incremental = 0;
+    long relexed = 0;
+    long reparsed = 0;
+    for (int i = 0; i < edits; ++i)
+    {
+        int size = inc.text ().size ();
+        int at = size > 0 ? random () % size : 0;
+        int removed = std::min<int> (random () % 3, size - at);
+        std::string inserted = random () % 4 ? PIECES[random () % pieceCount] : "";
+
+        begin = std::chrono::steady_clock::now ();
+        inc.edit (at, at + removed, inserted);
+        bool valid = inc.valid ();
+        incremental += seconds (begin);
+        relexed += inc.tokensRelexed ();
+        reparsed += inc.declarationsReparsed ();
+
+        if (i < CHECKED)
+        {
+            std::string expected = fullParse (inc.text (), tokens);
+            if (!sameTokens (tokens, inc.tokens ()) || valid != expected.empty () ||
+                inc.firstError () != expected)
+            {
+                fprintf (stderr, "edit %d (%d, %d, \"%s\") disagrees with a full parse\n",
+                         i, at, at + removed, inserted.c_str ());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    printf ("%s: %zu bytes, %zu tokens, %d edits (first %d verified)\n", argv[1],
+            text.size (), tokens.size (), edits, std::min (edits, CHECKED));
+    printf ("full lex+parse        %10.1f us\n", full * 1e6);
+    printf ("incremental per edit  %10.1f us  (%.1f tokens re-lexed, %.2f declarations re-parsed)\n",
+            incremental / edits * 1e6, (double) relexed / edits, (double) reparsed / edits);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,317 @@
+/*
+    Filename    : IncrementalParser.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Incremental Parsing
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "IncrementalParser.h"
+
+/***********************/
+
+// How far past m_index the grammar functions look
+static const int LOOKAHEAD = 2;
+
+static std::vector<Token>
+lexAll (const std::string& text)
+{
+    Lexer lex (text.data (), text.size ());
+    return lex.tokenize ();
+}
+
+static bool
+sameToken (const Token& a, const Token& b)
+{
+    return a.type == b.type && a.column == b.column && a.lexeme == b.lexeme;
+}
+
+/***********************/
+
+IncrementalParser::IncrementalParser (const std::string& text)
+    : m_text (text), m_parser (lexAll (text)), m_errors (0)
+{
+    m_relexed = m_parser.m_tokens.size ();
+    reparse (0, 0, m_parser.m_tokens.size ());
+}
+
+IncrementalParser::~IncrementalParser ()
+{
+}
+
+void
+IncrementalParser::edit (int begin, int end, const std::string& replacement)
+{
+    std::vector<Token>& tokens = m_parser.m_tokens;
+    int delta = replacement.size () - (end - begin);
+    m_text.replace (begin, end - begin, replacement);
+
+    // Tokens that end, lookahead included, before the edit are unchanged.
+    // Re-lex from the start of the last of them: tokens always start
+    // outside comments, so its line, column and offset are all the lexer
+    // needs to carry on from there.
+    int first = std::lower_bound (tokens.begin (), tokens.end () - 1, begin,
+                                  [] (const Token& t, int offset) {
+                                      return t.offset < offset;
+                                  }) - tokens.begin ();
+    while (first > 0 && tokens[first - 1].offset + (int) tokens[first - 1].lexeme.size () >= begin)
+    {
+        --first;
+    }
+    int restart = 0;
+    int line = 1;
+    int column = 1;
+    if (first > 0)
+    {
+        --first;
+        const Token& t = tokens[first];
+        restart = t.offset;
+        line = t.line;
+        column = t.column - t.lexeme.size ();
+    }
+    Lexer lex (m_text.data () + restart, m_text.size () - restart);
+    lex.setStart (line, column, restart);
+
+    // Re-lex until a token lines up with an old token from after the edit
+    int old = std::lower_bound (tokens.begin () + first, tokens.end () - 1, end,
+                                [] (const Token& t, int offset) {
+                                    return t.offset < offset;
+                                }) - tokens.begin ();
+    std::vector<Token> relexed;
+    int lineDelta = 0;
+    while (true)
+    {
+        Token t = lex.getToken ();
+        while (old < (int) tokens.size () - 1 && tokens[old].offset + delta < t.offset)
+        {
+            ++old;
+        }
+        if (tokens[old].offset + delta == t.offset && sameToken (tokens[old], t))
+        {
+            lineDelta = t.line - tokens[old].line;
+            break;
+        }
+        relexed.push_back (std::move (t));
+        if (relexed.back ().type == END_OF_FILE)
+        {
+            old = tokens.size ();
+            break;
+        }
+    }
+
+    // Splice, then shift what followed the edit. END_OF_FILE always
+    // reports line 1, so only its offset moves.
+    int newEnd = first + relexed.size ();
+    if (newEnd > old)
+    {
+        tokens.insert (tokens.begin () + old, newEnd - old, Token ());
+    }
+    else if (newEnd < old)
+    {
+        tokens.erase (tokens.begin () + newEnd, tokens.begin () + old);
+    }
+    std::move (relexed.begin (), relexed.end (), tokens.begin () + first);
+    for (size_t i = newEnd; i < tokens.size (); ++i)
+    {
+        tokens[i].offset += delta;
+        if (tokens[i].type != END_OF_FILE)
+        {
+            tokens[i].line += lineDelta;
+        }
+    }
+    m_relexed = relexed.size ();
+
+    reparse (first, old, newEnd);
+}
+
+// Tokens [firstChanged, newEnd) replaced [firstChanged, oldEnd). Parses
+// declarations again from the one that could have looked at the first
+// changed token until a declaration boundary past the change lines up
+// with an old one.
+void
+IncrementalParser::reparse (int firstChanged, int oldEnd, int newEnd)
+{
+    const std::vector<Token>& tokens = m_parser.m_tokens;
+    int tokenDelta = newEnd - oldEnd;
+
+    size_t from = 0;
+    while (from + 1 < m_declarations.size () &&
+           m_declarations[from + 1].start < firstChanged - LOOKAHEAD)
+    {
+        ++from;
+    }
+    int pos = from < m_declarations.size () ? m_declarations[from].start : 0;
+
+    std::vector<Declaration> reparsed;
+    size_t resume = from;
+    while (tokens[pos].type != END_OF_FILE)
+    {
+        if (pos >= newEnd)
+        {
+            while (resume < m_declarations.size () &&
+                   (m_declarations[resume].start < oldEnd ||
+                    m_declarations[resume].start + tokenDelta < pos))
+            {
+                ++resume;
+            }
+            if (resume < m_declarations.size () &&
+                m_declarations[resume].start + tokenDelta == pos)
+            {
+                break;
+            }
+        }
+        pos = parseDeclaration (pos, reparsed);
+    }
+    if (tokens[pos].type == END_OF_FILE)
+    {
+        resume = m_declarations.size ();
+    }
+
+    for (size_t i = from; i < resume; ++i)
+    {
+        m_errors -= m_declarations[i].error.index >= 0;
+    }
+    for (const Declaration& d : reparsed)
+    {
+        m_errors += d.error.index >= 0;
+    }
+    for (size_t i = resume; i < m_declarations.size (); ++i)
+    {
+        m_declarations[i].start += tokenDelta;
+        if (m_declarations[i].error.index >= 0)
+        {
+            m_declarations[i].error.index += tokenDelta;
+        }
+    }
+    m_declarations.erase (m_declarations.begin () + from, m_declarations.begin () + resume);
+    m_declarations.insert (m_declarations.begin () + from, reparsed.begin (), reparsed.end ());
+    m_reparsed = reparsed.size ();
+}
+
+// Parses the declaration at start and returns where the next one begins
+int
+IncrementalParser::parseDeclaration (int start, std::vector<Declaration>& out)
+{
+    Declaration d = { start, ParseError ("", END_OF_FILE, -1) };
+    m_parser.m_index = start;
+    int next;
+    try
+    {
+        m_parser.declaration ();
+        next = m_parser.m_index;
+    }
+    catch (const ParseError& e)
+    {
+        d.error = e;
+        next = recover (start);
+    }
+    out.push_back (d);
+    return next;
+}
+
+// After an error, the next declaration is taken to start at the next
+// 'int' or 'void' outside any brackets
+int
+IncrementalParser::recover (int start)
+{
+    const std::vector<Token>& tokens = m_parser.m_tokens;
+    int depth = 0;
+    int i = start;
+    while (true)
+    {
+        TokenType type = tokens[i].type;
+        if (type == LPAREN || type == LBRACK || type == LBRACE)
+        {
+            ++depth;
+        }
+        else if (type == RPAREN || type == RBRACK || type == RBRACE)
+        {
+            depth = std::max (depth - 1, 0);
+        }
+        ++i;
+        type = tokens[i].type;
+        if (type == END_OF_FILE || (depth == 0 && (type == INT || type == VOID)))
+        {
+            return i;
+        }
+    }
+}
+
+const std::string&
+IncrementalParser::text ()
+{
+    return m_text;
+}
+
+const std::vector<Token>&
+IncrementalParser::tokens ()
+{
+    return m_parser.m_tokens;
+}
+
+bool
+IncrementalParser::valid ()
+{
+    return !m_declarations.empty () && m_errors == 0;
+}
+
+std::string
+IncrementalParser::firstError ()
+{
+    if (m_declarations.empty ())
+    {
+        return m_parser.describe (ParseError ("program", INT, 0));
+    }
+    for (const Declaration& d : m_declarations)
+    {
+        if (d.error.index >= 0)
+        {
+            return m_parser.describe (d.error);
+        }
+    }
+    return "";
+}
+
+std::vector<ParseError>
+IncrementalParser::errors ()
+{
+    std::vector<ParseError> found;
+    if (m_declarations.empty ())
+    {
+        found.push_back (ParseError ("program", INT, 0));
+    }
+    for (size_t i = 0; i < m_declarations.size () && (int) found.size () < m_errors; ++i)
+    {
+        if (m_declarations[i].error.index >= 0)
+        {
+            found.push_back (m_declarations[i].error);
+        }
+    }
+    return found;
+}
+
+std::string
+IncrementalParser::describe (const ParseError& e)
+{
+    return m_parser.describe (e);
+}
+
+int
+IncrementalParser::tokensRelexed ()
+{
+    return m_relexed;
+}
+
+int
+IncrementalParser::declarationsReparsed ()
+{
+    return m_reparsed;
+}
@@ -0,0 +1,99 @@
+/*
+    Filename    : IncrementalParser.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Incremental Parsing
+*/
+
+/***********************/
+
+#ifndef INCREMENTAL_PARSER_H
+#define INCREMENTAL_PARSER_H
+
+/***********************/
+
+#include <string>
+#include <vector>
+
+#include "Lexer.h"
+#include "Parser.h"
+
+/***********************/
+
+// Keeps the tokens and per-declaration parse results of a source that
+// is being edited. An edit is re-lexed from the last token that ends
+// before it until the token stream lines up with the old one again, and
+// only the top-level declarations covering the changed tokens are parsed
+// again. Tokens after the edit are moved and renumbered in one linear
+// pass rather than re-lexed, which is the only part that grows with the
+// size of the file.
+class IncrementalParser
+{
+public:
+    IncrementalParser (const std::string& text);
+
+    ~IncrementalParser ();
+
+    // Replaces the bytes [begin, end) of the source with replacement
+    void
+    edit (int begin, int end, const std::string& replacement);
+
+    const std::string&
+    text ();
+
+    const std::vector<Token>&
+    tokens ();
+
+    // True if CMinus would print "Valid!" for the current source
+    bool
+    valid ();
+
+    // The diagnostic CMinus would print, or "" when valid
+    std::string
+    firstError ();
+
+    // One error per declaration that failed to parse, in source order
+    std::vector<ParseError>
+    errors ();
+
+    // The diagnostic text for e
+    std::string
+    describe (const ParseError& e);
+
+    // Work done by the last edit
+    int
+    tokensRelexed ();
+
+    int
+    declarationsReparsed ();
+
+private:
+    // A top-level declaration spans tokens [start, next start). error
+    // has index -1 when the declaration parsed.
+    struct Declaration
+    {
+        int start;
+        ParseError error;
+    };
+
+    int
+    parseDeclaration (int start, std::vector<Declaration>& out);
+
+    int
+    recover (int start);
+
+    void
+    reparse (int firstChanged, int oldEnd, int newEnd);
+
+private:
+    std::string m_text;
+    Parser m_parser;            // m_parser.m_tokens is the token stream
+    std::vector<Declaration> m_declarations;
+    int m_errors;
+    int m_relexed;
+    int m_reparsed;
+};
+
+/***********************/
+
+#endif
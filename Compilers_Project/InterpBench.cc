@@ -0,0 +1,112 @@
+/*
+    Filename    : InterpBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Interpreter
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/***********************/
+// Local includes
+
+#include "Ast.h"
+#include "BenchClock.h"
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+/***********************/
+
+// Times the Interpreter on each program: resolving names once, then
+// running main repeatedly. The programs in bench/ take no input; what
+// they print is shown once, so a run can be checked against the expected
+// values in their comments and against other back ends.
+//   usage: InterpBench [--reps=N] file.cm...
+
+/***********************/
+
+int
+main (int argc, char* argv[])
+{
+    int reps = 5;
+    int first = 1;
+    if (argc > 1 && std::string (argv[1]).compare (0, 7, "--reps=") == 0)
+    {
+        reps = std::max (1, atoi (argv[1] + 7));
+        ++first;
+    }
+    if (first >= argc)
+    {
+        fprintf (stderr, "usage: %s [--reps=N] file.cm...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf ("%-16s %10s %10s %10s %12s %12s  %s\n", "program", "resolve", "min", "median",
+            "Mcalls/s", "Mstmts/s", "output");
+    for (int i = first; i < argc; ++i)
+    {
+        FILE* srcFile = fopen (argv[i], "r");
+        if (srcFile == NULL)
+        {
+            perror (argv[i]);
+            return EXIT_FAILURE;
+        }
+        Lexer lex (srcFile);
+        Parser pars (lex.tokenize ());
+        Ast ast;
+        std::string message = pars.parse (ast);
+        if (!message.empty ())
+        {
+            fprintf (stderr, "%s:%s", argv[i], message.c_str ());
+            return EXIT_FAILURE;
+        }
+
+        auto begin = std::chrono::steady_clock::now ();
+        Interpreter interpreter (ast, pars.m_tokens);
+        double resolve = seconds (begin);
+
+        std::vector<double> times;
+        std::string output;
+        for (int r = 0; r < reps; ++r)
+        {
+            FILE* out = tmpfile ();
+            begin = std::chrono::steady_clock::now ();
+            message = interpreter.run (stdin, out);
+            times.push_back (seconds (begin));
+            if (!message.empty ())
+            {
+                fprintf (stderr, "%s:%s", argv[i], message.c_str ());
+                return EXIT_FAILURE;
+            }
+            rewind (out);
+            output.clear ();
+            char buffer[4096];
+            size_t n;
+            while ((n = fread (buffer, 1, sizeof (buffer), out)) > 0)
+            {
+                output.append (buffer, n);
+            }
+            fclose (out);
+        }
+        std::replace (output.begin (), output.end (), '\n', ' ');
+
+        std::sort (times.begin (), times.end ());
+        double median = times[times.size () / 2];
+        const InterpreterStats& stats = interpreter.stats ();
+        std::string name (argv[i]);
+        name = name.substr (name.find_last_of ('/') + 1);
+        printf ("%-16s %8.3fms %9.3fs %9.3fs %12.3f %12.3f  %s\n", name.c_str (), resolve * 1e3,
+                times.front (), median, stats.calls / median / 1e6, stats.statements / median / 1e6,
+                output.c_str ());
+    }
+    return EXIT_SUCCESS;
+}
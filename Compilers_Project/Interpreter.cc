@@ -0,0 +1,931 @@
+/*
+    Filename    : Interpreter.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Interpreter
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <pthread.h>
+#include <sys/time.h>
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "Interpreter.h"
+#include "SymbolTable.h"
+#include "TailCall.h"
+
+/***********************/
+
+namespace
+{
+    enum CodeKind
+    {
+        CODE_NOP,           // declarations
+        CODE_NUM,           // slot is the value
+        CODE_LOAD,          // a scalar variable
+        CODE_ARRAY,         // a whole array, as a call argument
+        CODE_LOAD_ELEM,     // index
+        CODE_STORE,         // target, value; depth and slot are the target's
+        CODE_STORE_ELEM,    // target (a CODE_LOAD_ELEM), value
+        CODE_BINARY,
+        CODE_CALL,          // arguments
+        CODE_TAIL_CALL,     // as CODE_CALL, returned; it takes over the frame
+        CODE_INPUT,
+        CODE_OUTPUT,        // value
+        CODE_BLOCK,         // slot is the number of declarations to skip
+        CODE_EXPR,
+        CODE_IF,
+        CODE_WHILE,
+        CODE_RETURN
+    };
+
+    // Thrown by Interpreter::trap and caught by run ()
+    struct Trap
+    {
+        const char* what;
+        uint32_t token;
+    };
+
+    // The program runs on its own stack, so recursion is bounded by
+    // MAX_NESTING rather than by the caller's ulimit. One level of nesting
+    // is one eval () or exec () on the C++ stack.
+    const size_t RUN_STACK_BYTES = 512 * 1024 * 1024;
+    const uint64_t MAX_NESTING = RUN_STACK_BYTES / 512;
+
+    // A sample of a deeper stack keeps the innermost frames
+    const size_t MAX_SAMPLED_FRAMES = 128;
+
+    void*
+    runOnStack (void* arg)
+    {
+        (*(std::function<void ()>*) arg) ();
+        return NULL;
+    }
+}
+
+/***********************/
+
+volatile sig_atomic_t Interpreter::s_sampleDue = 0;
+
+/***********************/
+
+Interpreter::Interpreter (const Ast& ast, const std::vector<Token>& tokens,
+                          const InterpreterLimits& limits)
+    : m_tokens (tokens), m_main (NULL), m_limits (limits), m_arena (limits.memory), m_in (NULL),
+      m_out (NULL), m_returnValue (0), m_tailCall (0), m_depth (0), m_nesting (0), m_stats (),
+      m_profiling (false), m_profileHz (0)
+{
+    resolve (ast);
+}
+
+Interpreter::~Interpreter ()
+{
+}
+
+const std::string&
+Interpreter::error () const
+{
+    return m_error;
+}
+
+const InterpreterStats&
+Interpreter::stats () const
+{
+    return m_stats;
+}
+
+std::string
+InterpreterStats::report () const
+{
+    char line[256];
+    snprintf (line, sizeof (line),
+              "run: %llu calls, %llu statements; call depth %u; %llu bytes of globals, "
+              "%llu bytes of frames at most, %llu bytes of arena",
+              (unsigned long long) calls, (unsigned long long) statements, maxCallDepth,
+              (unsigned long long) globalBytes, (unsigned long long) maxFrameBytes,
+              (unsigned long long) arenaBytes);
+    return line;
+}
+
+/***********************/
+
+void
+Interpreter::fail (const char* what, uint32_t token)
+{
+    if (m_error.empty ())
+    {
+        const Token& t = m_tokens[token];
+        char buffer[128];
+        snprintf (buffer, sizeof (buffer), " (line %d, column %d)\n", t.line, t.column);
+        m_error = std::string ("\n Error while resolving: ") + what + "\n\tAt: " + t.lexeme + buffer;
+    }
+}
+
+void
+Interpreter::resolve (const Ast& ast)
+{
+    const std::vector<AstNode>& nodes = ast.nodes ();
+    if (nodes.empty ())
+    {
+        m_error = "\n Error while resolving: no program\n";
+        return;
+    }
+    m_children = ast.children ();
+    m_code.resize (nodes.size ());
+    std::vector<uint32_t> end (nodes.size ());
+    std::vector<uint32_t> height (nodes.size ());
+    for (uint32_t id = nodes.size (); id-- > 0; )
+    {
+        const AstNode& n = nodes[id];
+        Code& c = m_code[id];
+        c.kind = CODE_NOP;
+        c.op = n.op;
+        c.depth = 0;
+        c.slot = 0;
+        c.first = n.firstChild;
+        c.count = n.childCount;
+        c.function = NULL;
+        c.token = n.token;
+        end[id] = id + 1;
+        height[id] = 1;
+        for (uint32_t k = 0; k < n.childCount; ++k)
+        {
+            uint32_t child = ast.child (id, k);
+            end[id] = end[child];
+            height[id] = std::max (height[id], 1 + height[child]);
+        }
+    }
+
+    // What a declaring token resolves to
+    struct Binding
+    {
+        uint8_t kind;
+        uint8_t depth;
+        uint32_t slot;
+        const Function* function;
+    };
+    Binding unbound = { AST_EMPTY, 0, 0, NULL };
+    std::vector<Binding> bindings (m_tokens.size (), unbound);
+
+    // Globals and functions first, so calls can go forward
+    std::vector<uint32_t> functionDecls;
+    m_globalFrame.body = 0;
+    m_globalFrame.params = 0;
+    m_globalFrame.slots = 0;
+    m_globalFrame.height = 0;
+    m_globalFrame.arrayCells = 0;
+    m_globalFrame.token = 0;
+    m_globalFrame.index = 0;
+    for (uint32_t k = 0; k < nodes[0].childCount; ++k)
+    {
+        uint32_t d = ast.child (0, k);
+        const AstNode& n = nodes[d];
+        Binding& b = bindings[n.token];
+        b.kind = n.kind;
+        b.depth = 1;
+        if (n.kind == AST_FUN_DECL)
+        {
+            Function f;
+            f.body = ast.child (d, n.childCount - 1);
+            f.params = n.childCount - 1;
+            f.slots = f.params;
+            f.height = height[f.body];
+            f.arrayCells = 0;
+            f.token = n.token;
+            f.index = m_functions.size ();
+            m_functions.push_back (f);
+            b.function = &m_functions.back ();
+            functionDecls.push_back (d);
+            if (m_tokens[n.token].lexeme == "main")
+            {
+                m_main = b.function;
+            }
+        }
+        else
+        {
+            b.slot = m_globalFrame.slots++;
+            if (n.kind == AST_ARRAY_DECL)
+            {
+                m_globalFrame.localArrays.push_back (std::make_pair (b.slot, (uint32_t) n.value));
+                m_globalFrame.arrayCells += n.value;
+            }
+        }
+    }
+
+    SymbolTable symbols (m_tokens);
+    for (size_t i = 0; i < functionDecls.size (); ++i)
+    {
+        Function& f = m_functions[i];
+        uint32_t decl = functionDecls[i];
+
+        // Declarations and leaves; preorder is source order, so every
+        // declaration is bound before its uses
+        for (uint32_t id = decl + 1; id < end[decl]; ++id)
+        {
+            const AstNode& n = nodes[id];
+            Code& c = m_code[id];
+            switch (n.kind)
+            {
+                case AST_PARAM:
+                case AST_ARRAY_PARAM:
+                case AST_VAR_DECL:
+                case AST_ARRAY_DECL:
+                {
+                    Binding& b = bindings[n.token];
+                    b.kind = n.kind;
+                    b.depth = 0;
+                    b.slot = id < f.body ? id - decl - 1 : f.slots++;
+                    if (n.kind == AST_ARRAY_PARAM)
+                    {
+                        f.arrayParams.push_back (b.slot);
+                    }
+                    else if (n.kind == AST_ARRAY_DECL)
+                    {
+                        f.localArrays.push_back (std::make_pair (b.slot, (uint32_t) n.value));
+                        f.arrayCells += n.value;
+                    }
+                    break;
+                }
+
+                case AST_COMPOUND:
+                    c.kind = CODE_BLOCK;
+                    while (c.slot < n.childCount &&
+                           (nodes[ast.child (id, c.slot)].kind == AST_VAR_DECL ||
+                            nodes[ast.child (id, c.slot)].kind == AST_ARRAY_DECL))
+                    {
+                        ++c.slot;
+                    }
+                    break;
+
+                case AST_EXPR_STMT: c.kind = CODE_EXPR; break;
+                case AST_IF:
+                case AST_WHILE:
+                    c.kind = n.kind == AST_IF ? CODE_IF : CODE_WHILE;
+                    for (uint32_t k = 1; k < n.childCount; ++k)
+                    {
+                        if (nodes[ast.child (id, k)].kind == AST_EMPTY)
+                        {
+                            fail ("missing statement", nodes[ast.child (id, k)].token);
+                        }
+                    }
+                    break;
+
+                case AST_RETURN:    c.kind = CODE_RETURN; break;
+                case AST_BINARY:    c.kind = CODE_BINARY; break;
+
+                case AST_NUM:
+                    c.kind = CODE_NUM;
+                    c.slot = (uint32_t) n.value;
+                    break;
+
+                case AST_VAR:
+                case AST_SUBSCRIPT:
+                {
+                    int d = symbols.definition (n.token);
+                    if (d < 0 || bindings[d].kind == AST_EMPTY)
+                    {
+                        fail ("undeclared variable", n.token);
+                        break;
+                    }
+                    const Binding& b = bindings[d];
+                    bool isArray = b.kind == AST_ARRAY_DECL || b.kind == AST_ARRAY_PARAM;
+                    if (b.kind == AST_FUN_DECL)
+                    {
+                        fail ("a function used as a variable", n.token);
+                    }
+                    else if (n.kind == AST_SUBSCRIPT && !isArray)
+                    {
+                        fail ("subscript of a variable that is not an array", n.token);
+                    }
+                    c.kind = n.kind == AST_SUBSCRIPT ? CODE_LOAD_ELEM : isArray ? CODE_ARRAY : CODE_LOAD;
+                    c.depth = b.depth;
+                    c.slot = b.slot;
+                    break;
+                }
+
+                case AST_CALL:
+                {
+                    int d = symbols.definition (n.token);
+                    const std::string& name = m_tokens[n.token].lexeme;
+                    if (d < 0 && name == "input" && n.childCount == 0)
+                    {
+                        c.kind = CODE_INPUT;
+                    }
+                    else if (d < 0 && name == "output" && n.childCount == 1)
+                    {
+                        c.kind = CODE_OUTPUT;
+                    }
+                    else if (d < 0 || bindings[d].kind == AST_EMPTY)
+                    {
+                        fail (name == "input" || name == "output" ? "wrong number of arguments"
+                                                                  : "undeclared function",
+                              n.token);
+                    }
+                    else if (bindings[d].kind != AST_FUN_DECL)
+                    {
+                        fail ("a variable called as a function", n.token);
+                    }
+                    else if (bindings[d].function->params != n.childCount)
+                    {
+                        fail ("wrong number of arguments", n.token);
+                    }
+                    else
+                    {
+                        c.kind = CODE_CALL;
+                        c.function = bindings[d].function;
+                    }
+                    break;
+                }
+
+                case AST_EMPTY:
+                    fail ("missing expression", n.token);
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        // Assignments, and where whole arrays may appear: only as
+        // arguments for array parameters
+        for (uint32_t id = decl + 1; id < end[decl]; ++id)
+        {
+            Code& c = m_code[id];
+            if (nodes[id].kind == AST_ASSIGN)
+            {
+                const Code& target = m_code[m_children[c.first]];
+                if (target.kind == CODE_LOAD)
+                {
+                    c.kind = CODE_STORE;
+                    c.depth = target.depth;
+                    c.slot = target.slot;
+                }
+                else if (target.kind == CODE_LOAD_ELEM)
+                {
+                    c.kind = CODE_STORE_ELEM;
+                }
+                else if (target.kind == CODE_ARRAY)
+                {
+                    fail ("assignment to a whole array", target.token);
+                }
+            }
+            for (uint32_t k = 0; k < c.count; ++k)
+            {
+                const Code& child = m_code[m_children[c.first + k]];
+                bool wantArray = c.kind == CODE_CALL &&
+                                 std::find (c.function->arrayParams.begin (), c.function->arrayParams.end (), k) !=
+                                 c.function->arrayParams.end ();
+                if (c.kind == CODE_STORE && k == 0)
+                {
+                    continue;
+                }
+                if (wantArray && child.kind != CODE_ARRAY)
+                {
+                    fail ("a scalar passed for an array parameter", child.token);
+                }
+                else if (!wantArray && child.kind == CODE_ARRAY)
+                {
+                    fail ("an array used as a value", child.token);
+                }
+            }
+        }
+    }
+
+    // A call returned as it is made runs in place of its caller, unless an
+    // argument is one of the caller's local arrays
+    TailCallAnalysis tailCalls (ast, m_tokens);
+    for (const TailCall& t : tailCalls.calls ())
+    {
+        if (t.reusesFrame && m_code[t.node].kind == CODE_CALL)
+        {
+            m_code[t.node].kind = CODE_TAIL_CALL;
+        }
+    }
+
+    if (m_main == NULL)
+    {
+        if (m_error.empty ())
+        {
+            m_error = "\n Error while resolving: no main function\n";
+        }
+    }
+    else if (m_main->params != 0)
+    {
+        fail ("main takes no parameters", m_main->token);
+    }
+}
+
+/***********************/
+
+std::string
+Interpreter::run (FILE* in, FILE* out)
+{
+    if (!m_error.empty ())
+    {
+        return m_error;
+    }
+    m_in = in;
+    m_out = out;
+    m_depth = 0;
+    m_nesting = 0;
+    m_tailCall = 0;
+    m_tailArgs.clear ();
+    m_stats = InterpreterStats ();
+    m_stats.globalBytes = m_globalFrame.frameBytes ();
+    if (m_stats.globalBytes > m_limits.memory)
+    {
+        return "\n Runtime error: the globals exceed the memory limit\n";
+    }
+    m_globals.assign (m_globalFrame.slots, Slot ());
+    m_globalArrays.assign (m_globalFrame.arrayCells, 0);
+    layout (m_globalFrame, m_globals.data (), m_globalArrays.data ());
+    m_arena.reset (m_limits.memory - m_stats.globalBytes);
+    if (m_profiling)
+    {
+        m_calling.clear ();
+        m_functionCounts.assign (m_functions.size (), FunctionCounts ());
+        m_trueCounts.assign (m_code.size (), 0);
+        m_falseCounts.assign (m_code.size (), 0);
+        m_folded.clear ();
+    }
+
+    std::string message;
+    std::function<void ()> body = [this, &message] ()
+    {
+        try
+        {
+            ++m_stats.calls;
+            m_nesting = m_main->height;
+            if (m_nesting > MAX_NESTING)
+            {
+                trap ("out of stack", m_main->body);
+            }
+            const Function* f = m_main;
+            FrameArena::Mark mark = m_arena.mark ();
+            Slot* frame = enter (*m_main, m_main->body);
+            if (m_profiling)
+            {
+                m_calling.push_back (std::make_pair (m_main, m_main->body));
+                ++m_functionCounts[m_main->index].calls;
+            }
+            invoke (f, frame, mark);
+        }
+        catch (const Trap& t)
+        {
+            const Token& token = m_tokens[t.token];
+            char buffer[128];
+            snprintf (buffer, sizeof (buffer), " (line %d, column %d)\n", token.line, token.column);
+            message = std::string ("\n Runtime error: ") + t.what + "\n\tAt: " + token.lexeme + buffer;
+        }
+    };
+    // ITIMER_PROF counts the CPU time of the whole process, which is the
+    // program's thread while this one waits for it
+    struct itimerval timer;
+    memset (&timer, 0, sizeof (timer));
+    if (m_profiling && m_profileHz > 0)
+    {
+        struct sigaction action;
+        memset (&action, 0, sizeof (action));
+        action.sa_handler = onSample;
+        action.sa_flags = SA_RESTART;
+        sigaction (SIGPROF, &action, NULL);
+        s_sampleDue = 0;
+        timer.it_interval.tv_usec = m_profileHz >= 1000000 ? 1 : 1000000 / m_profileHz;
+        timer.it_value = timer.it_interval;
+        setitimer (ITIMER_PROF, &timer, NULL);
+    }
+    pthread_attr_t attr;
+    pthread_attr_init (&attr);
+    pthread_attr_setstacksize (&attr, RUN_STACK_BYTES);
+    pthread_t thread;
+    if (pthread_create (&thread, &attr, runOnStack, &body) != 0)
+    {
+        message = "\n Runtime error: no memory for the program's stack\n";
+    }
+    else
+    {
+        pthread_join (thread, NULL);
+    }
+    pthread_attr_destroy (&attr);
+    if (m_profiling && m_profileHz > 0)
+    {
+        memset (&timer, 0, sizeof (timer));
+        setitimer (ITIMER_PROF, &timer, NULL);
+        signal (SIGPROF, SIG_IGN);
+    }
+    fflush (m_out);
+    m_stats.maxFrameBytes = m_arena.highWater ();
+    m_stats.arenaBytes = m_arena.reserved ();
+    return message;
+}
+
+void
+Interpreter::trap (const char* what, uint32_t id)
+{
+    throw Trap { what, m_code[id].token };
+}
+
+/***********************/
+
+void
+Interpreter::profile (int hz)
+{
+    m_profiling = true;
+    m_profileHz = hz;
+}
+
+void
+Interpreter::onSample (int signum)
+{
+    (void) signum;
+    s_sampleDue = 1;
+}
+
+void
+Interpreter::count (uint32_t id)
+{
+    ++m_functionCounts[m_calling.back ().first->index].statements;
+    if (!s_sampleDue)
+    {
+        return;
+    }
+    s_sampleDue = 0;
+    ++m_functionCounts[m_calling.back ().first->index].samples;
+
+    // Each frame is a function and the line it is at: the call it is
+    // making, or for the innermost, statement id
+    std::string stack;
+    size_t first = m_calling.size () > MAX_SAMPLED_FRAMES ? m_calling.size () - MAX_SAMPLED_FRAMES : 0;
+    for (size_t i = first; i < m_calling.size (); ++i)
+    {
+        uint32_t at = i + 1 < m_calling.size () ? m_calling[i + 1].second : id;
+        stack += m_tokens[m_calling[i].first->token].lexeme + ":" +
+                 std::to_string (m_tokens[m_code[at].token].line);
+        stack += i + 1 < m_calling.size () ? ";" : "";
+    }
+    ++m_folded[first > 0 ? "(deeper);" + stack : stack];
+}
+
+std::string
+Interpreter::profileReport () const
+{
+    std::string report;
+    char line[256];
+    snprintf (line, sizeof (line), "%-18s %12s %14s %10s\n", "FUNCTION", "CALLS", "STATEMENTS", "SAMPLES");
+    report += line;
+    for (const Function& f : m_functions)
+    {
+        const FunctionCounts& c = m_functionCounts[f.index];
+        if (c.calls == 0)
+        {
+            continue;
+        }
+        snprintf (line, sizeof (line), "%-18s %12llu %14llu %10llu\n", m_tokens[f.token].lexeme.c_str (),
+                  (unsigned long long) c.calls, (unsigned long long) c.statements,
+                  (unsigned long long) c.samples);
+        report += line;
+    }
+    snprintf (line, sizeof (line), "%-18s %12s %14s\n", "TEST", "TRUE", "FALSE");
+    report += line;
+    for (uint32_t id = 0; id < m_code.size (); ++id)
+    {
+        const Code& c = m_code[id];
+        if ((c.kind != CODE_IF && c.kind != CODE_WHILE) || m_trueCounts[id] + m_falseCounts[id] == 0)
+        {
+            continue;
+        }
+        const Token& t = m_tokens[c.token];
+        char where[64];
+        snprintf (where, sizeof (where), "%s line %d", c.kind == CODE_IF ? "if" : "while", t.line);
+        snprintf (line, sizeof (line), "%-18s %12llu %14llu\n", where, (unsigned long long) m_trueCounts[id],
+                  (unsigned long long) m_falseCounts[id]);
+        report += line;
+    }
+    return report;
+}
+
+void
+Interpreter::writeFolded (FILE* out) const
+{
+    for (const std::pair<const std::string, uint64_t>& stack : m_folded)
+    {
+        fprintf (out, "%s %llu\n", stack.first.c_str (), (unsigned long long) stack.second);
+    }
+}
+
+/***********************/
+
+int32_t
+Interpreter::eval (uint32_t id, Slot* frame)
+{
+    const Code& c = m_code[id];
+    switch (c.kind)
+    {
+        case CODE_NUM:
+            return (int32_t) c.slot;
+
+        case CODE_LOAD:
+            return (c.depth == 0 ? frame : m_globals.data ())[c.slot].value;
+
+        case CODE_LOAD_ELEM:
+            return element (id, frame);
+
+        case CODE_STORE:
+        {
+            int32_t v = eval (m_children[c.first + 1], frame);
+            (c.depth == 0 ? frame : m_globals.data ())[c.slot].value = v;
+            return v;
+        }
+
+        case CODE_STORE_ELEM:
+        {
+            // The value is evaluated before the target, as in Cfg
+            int32_t v = eval (m_children[c.first + 1], frame);
+            element (m_children[c.first], frame) = v;
+            return v;
+        }
+
+        case CODE_BINARY:
+        {
+            int32_t a = eval (m_children[c.first], frame);
+            int32_t b = eval (m_children[c.first + 1], frame);
+            switch (c.op)
+            {
+                case PLUS:  return (int32_t) ((uint32_t) a + (uint32_t) b);
+                case MINUS: return (int32_t) ((uint32_t) a - (uint32_t) b);
+                case TIMES: return (int32_t) ((uint32_t) a * (uint32_t) b);
+                case DIVIDE:
+                    if (b == 0)
+                    {
+                        trap ("division by zero", id);
+                    }
+                    if (a == INT_MIN && b == -1)
+                    {
+                        trap ("division overflows", id);
+                    }
+                    return a / b;
+                case LT:    return a < b;
+                case LTE:   return a <= b;
+                case GT:    return a > b;
+                case GTE:   return a >= b;
+                case EQ:    return a == b;
+                case NEQ:   return a != b;
+                default:    trap ("unknown operator", id);
+            }
+        }
+
+        case CODE_CALL:
+        case CODE_TAIL_CALL:
+            return call (id, frame);
+
+        case CODE_INPUT:
+        {
+            ++m_stats.calls;
+            int v;
+            if (fscanf (m_in, "%d", &v) != 1)
+            {
+                trap ("input () found no integer", id);
+            }
+            return v;
+        }
+
+        case CODE_OUTPUT:
+        {
+            ++m_stats.calls;
+            int32_t v = eval (m_children[c.first], frame);
+            fprintf (m_out, "%d\n", v);
+            return 0;
+        }
+
+        default:
+            trap ("not an expression", id);
+    }
+}
+
+Interpreter::Array
+Interpreter::array (uint32_t id, Slot* frame)
+{
+    const Code& c = m_code[id];
+    return (c.depth == 0 ? frame : m_globals.data ())[c.slot].array;
+}
+
+int32_t&
+Interpreter::element (uint32_t id, Slot* frame)
+{
+    const Code& c = m_code[id];
+    Array a = (c.depth == 0 ? frame : m_globals.data ())[c.slot].array;
+    int32_t index = eval (m_children[c.first], frame);
+    if ((uint32_t) index >= a.length)
+    {
+        trap ("subscript out of range", id);
+    }
+    return a.data[index];
+}
+
+bool
+Interpreter::exec (uint32_t id, Slot* frame)
+{
+    const Code& c = m_code[id];
+    ++m_stats.statements;
+    if (m_profiling)
+    {
+        count (id);
+    }
+    switch (c.kind)
+    {
+        case CODE_BLOCK:
+            for (uint32_t k = c.slot; k < c.count; ++k)
+            {
+                if (exec (m_children[c.first + k], frame))
+                {
+                    return true;
+                }
+            }
+            return false;
+
+        case CODE_EXPR:
+            if (c.count > 0)
+            {
+                eval (m_children[c.first], frame);
+            }
+            return false;
+
+        case CODE_IF:
+        {
+            bool test = eval (m_children[c.first], frame) != 0;
+            if (m_profiling)
+            {
+                ++(test ? m_trueCounts : m_falseCounts)[id];
+            }
+            if (test)
+            {
+                return exec (m_children[c.first + 1], frame);
+            }
+            return c.count > 2 && exec (m_children[c.first + 2], frame);
+        }
+
+        case CODE_WHILE:
+            for (;;)
+            {
+                bool test = eval (m_children[c.first], frame) != 0;
+                if (m_profiling)
+                {
+                    ++(test ? m_trueCounts : m_falseCounts)[id];
+                }
+                if (!test)
+                {
+                    return false;
+                }
+                if (exec (m_children[c.first + 1], frame))
+                {
+                    return true;
+                }
+            }
+
+        case CODE_RETURN:
+            if (c.count > 0 && m_code[m_children[c.first]].kind == CODE_TAIL_CALL)
+            {
+                // Only the arguments; invoke () makes the call once this
+                // frame is gone
+                const Code& t = m_code[m_children[c.first]];
+                for (uint32_t k = 0; k < t.count; ++k)
+                {
+                    uint32_t arg = m_children[t.first + k];
+                    Slot s;
+                    if (m_code[arg].kind == CODE_ARRAY)
+                    {
+                        s.array = array (arg, frame);
+                    }
+                    else
+                    {
+                        s.value = eval (arg, frame);
+                    }
+                    m_tailArgs.push_back (s);
+                }
+                m_tailCall = m_children[c.first];
+                return true;
+            }
+            m_returnValue = c.count > 0 ? eval (m_children[c.first], frame) : 0;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// Arguments are evaluated left to right in the caller's frame, straight
+// into the callee's
+int32_t
+Interpreter::call (uint32_t id, Slot* frame)
+{
+    const Code& c = m_code[id];
+    const Function& f = *c.function;
+    ++m_stats.calls;
+    m_nesting += f.height;
+    if (m_nesting > MAX_NESTING)
+    {
+        trap ("out of stack", id);
+    }
+
+    FrameArena::Mark mark = m_arena.mark ();
+    Slot* callee = enter (f, id);
+    for (uint32_t k = 0; k < c.count; ++k)
+    {
+        uint32_t arg = m_children[c.first + k];
+        if (m_code[arg].kind == CODE_ARRAY)
+        {
+            callee[k].array = array (arg, frame);
+        }
+        else
+        {
+            callee[k].value = eval (arg, frame);
+        }
+    }
+
+    if (m_profiling)
+    {
+        m_calling.push_back (std::make_pair (&f, id));
+        ++m_functionCounts[f.index].calls;
+    }
+    const Function* returning = &f;
+    bool returned = invoke (returning, callee, mark);
+    if (m_profiling)
+    {
+        m_calling.pop_back ();
+    }
+    m_arena.pop (mark);
+    --m_depth;
+    m_nesting -= returning->height;
+    return returned ? m_returnValue : 0;
+}
+
+// Each tail call pops the frame before it and pushes its own at mark, so
+// a chain of them takes constant stack and memory
+bool
+Interpreter::invoke (const Function*& f, Slot* frame, const FrameArena::Mark& mark)
+{
+    bool returned = exec (f->body, frame);
+    while (returned && m_tailCall != 0)
+    {
+        uint32_t id = m_tailCall;
+        const Function& callee = *m_code[id].function;
+        m_tailCall = 0;
+        ++m_stats.calls;
+        m_nesting = m_nesting - f->height + callee.height;
+        if (m_nesting > MAX_NESTING)
+        {
+            trap ("out of stack", id);
+        }
+        m_arena.pop (mark);
+        --m_depth;
+        frame = enter (callee, id);
+        std::copy (m_tailArgs.end () - callee.params, m_tailArgs.end (), frame);
+        m_tailArgs.resize (m_tailArgs.size () - callee.params);
+        f = &callee;
+        if (m_profiling)
+        {
+            // The caller is still at the call that entered the frame
+            m_calling.back ().first = f;
+            ++m_functionCounts[f->index].calls;
+        }
+        returned = exec (f->body, frame);
+    }
+    return returned;
+}
+
+Interpreter::Slot*
+Interpreter::enter (const Function& f, uint32_t id)
+{
+    if (++m_depth > m_limits.calls)
+    {
+        trap ("too many nested calls", id);
+    }
+    m_stats.maxCallDepth = std::max (m_stats.maxCallDepth, m_depth);
+    Slot* frame = (Slot*) m_arena.push (f.frameBytes ());
+    if (frame == NULL)
+    {
+        trap ("the frames exceed the memory limit", id);
+    }
+    layout (f, frame, (int32_t*) (frame + f.slots));
+    return frame;
+}
+
+void
+Interpreter::layout (const Function& f, Slot* slots, int32_t* cells)
+{
+    for (const std::pair<uint32_t, uint32_t>& a : f.localArrays)
+    {
+        slots[a.first].array.data = cells;
+        slots[a.first].array.length = a.second;
+        cells += a.second;
+    }
+}
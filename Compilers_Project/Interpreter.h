@@ -0,0 +1,255 @@
+/*
+    Filename    : Interpreter.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Interpreter
+*/
+
+/***********************/
+
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+/***********************/
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Ast.h"
+#include "FrameArena.h"
+#include "Lexer.h"
+
+/***********************/
+
+struct InterpreterLimits
+{
+    size_t   memory = 256 << 20;    // bytes of globals, and of the
+                                    // blocks frames (local arrays
+                                    // included) are carved from
+    uint32_t calls = 1 << 20;       // calls in progress at once
+};
+
+struct InterpreterStats
+{
+    uint64_t calls;         // including input and output
+    uint64_t statements;
+    uint32_t maxCallDepth;
+    uint64_t globalBytes;
+    uint64_t maxFrameBytes; // high-water mark of live frames
+    uint64_t arenaBytes;    // blocks the frames were carved from
+
+    std::string
+    report () const;
+};
+
+// Runs a valid program by walking its syntax tree.
+//
+// All name resolution happens once, in the constructor. Every variable
+// becomes a (depth, slot) pair: depth 0 is the frame of the running
+// function, depth 1 the globals; C-Minus has no nested functions, so there
+// is nothing further out. Every call becomes a pointer to the callee's
+// Function, and input () and output () become built-in operations. run ()
+// then never looks at a name.
+//
+// ints are 32 bits and wrap; division truncates toward zero. Variables and
+// array elements start at zero. Dividing by zero, INT_MIN / -1, a subscript
+// out of range and running out of stack are run-time errors.
+//
+// Frames, local arrays included, come from a FrameArena rather than the
+// heap, and a call is bounded in memory as well as in depth: exceeding
+// either limit is a run-time error, so an untrusted program cannot take
+// more than limits allow.
+//
+// A 'return f (...);' that TailCallAnalysis says may reuse the frame is
+// made after the caller's frame is popped, so tail recursion runs in
+// constant stack and memory however deep it goes.
+//
+// After profile (), run () also counts, exactly, the calls to and the
+// statements run in each function and how each if and while test came
+// out, and samples the call stack on SIGPROF. The handler only notes that
+// a sample is due; the next statement takes it, so building the stack
+// never happens inside the signal.
+class Interpreter
+{
+public:
+    Interpreter (const Ast& ast, const std::vector<Token>& tokens,
+                 const InterpreterLimits& limits = InterpreterLimits ());
+
+    ~Interpreter ();
+
+    // "" if the program can run, or the first problem resolution found:
+    // an undeclared name, a scalar used as an array or the other way
+    // round, a call with the wrong number of arguments, no main
+    const std::string&
+    error () const;
+
+    // Calls main, reading input () from in and writing output () to out.
+    // Returns "" or the run-time error that stopped the program.
+    std::string
+    run (FILE* in, FILE* out);
+
+    const InterpreterStats&
+    stats () const;
+
+    // Profiles the runs that follow, sampling hz times a second of CPU
+    // time; hz <= 0 keeps the counts but takes no samples
+    void
+    profile (int hz);
+
+    // After a profiled run (): calls, statements and samples per function,
+    // then how often each test was true and false
+    std::string
+    profileReport () const;
+
+    // After a profiled run (): one "main:9;f:3 count" line per sampled
+    // stack, each frame a function and the line it was at, as
+    // flamegraph.pl reads them
+    void
+    writeFolded (FILE* out) const;
+
+private:
+    struct Array
+    {
+        int32_t* data;
+        uint32_t length;
+    };
+
+    union Slot
+    {
+        int32_t value;
+        Array array;
+    };
+
+    struct Function
+    {
+        uint32_t body;          // the AST_COMPOUND
+        uint32_t params;
+        uint32_t slots;         // params, then every local of every block
+        uint32_t height;        // deepest nesting of the body, in nodes
+        std::vector<uint32_t> arrayParams;
+        std::vector<std::pair<uint32_t, uint32_t>> localArrays;     // slot, length
+        uint64_t arrayCells;
+        uint32_t token;
+        uint32_t index;         // in m_functions
+
+        // Slots, then the cells of the local arrays
+        uint64_t
+        frameBytes () const
+        {
+            return slots * sizeof (Slot) + arrayCells * sizeof (int32_t);
+        }
+    };
+
+    // One per AST node, with the same children
+    struct Code
+    {
+        uint8_t  kind;          // see Interpreter.cc
+        uint8_t  op;            // the operator of a binary expression
+        uint8_t  depth;         // of a variable
+        uint32_t slot;          // of a variable; the value of a number
+        uint32_t first;
+        uint32_t count;
+        const Function* function;
+        uint32_t token;
+    };
+
+    void
+    resolve (const Ast& ast);
+
+    void
+    fail (const char* what, uint32_t token);
+
+    int32_t
+    eval (uint32_t id, Slot* frame);
+
+    Array
+    array (uint32_t id, Slot* frame);
+
+    int32_t&
+    element (uint32_t id, Slot* frame);
+
+    // True if a return statement ran
+    bool
+    exec (uint32_t id, Slot* frame);
+
+    int32_t
+    call (uint32_t id, Slot* frame);
+
+    // Runs f's body in frame, then the tail calls it ends with, each in a
+    // frame that replaces the last at mark; leaves f the function that
+    // returned. True if a return statement ran.
+    bool
+    invoke (const Function*& f, Slot* frame, const FrameArena::Mark& mark);
+
+    // Pushes f's frame onto the arena and points its local arrays at
+    // their cells
+    Slot*
+    enter (const Function& f, uint32_t id);
+
+    // Points f's local arrays in slots at consecutive runs of cells
+    static void
+    layout (const Function& f, Slot* slots, int32_t* cells);
+
+    [[noreturn]] void
+    trap (const char* what, uint32_t id);
+
+    // Counts statement id toward the running function, and takes a sample
+    // there if one is due
+    void
+    count (uint32_t id);
+
+    static void
+    onSample (int signum);
+
+private:
+    const std::vector<Token>& m_tokens;
+    std::vector<Code> m_code;
+    std::vector<uint32_t> m_children;
+    std::deque<Function> m_functions;
+    const Function* m_main;
+
+    // The globals, laid out as a frame
+    Function m_globalFrame;
+    std::vector<Slot> m_globals;
+    std::vector<int32_t> m_globalArrays;
+    std::string m_error;
+
+    InterpreterLimits m_limits;
+    FrameArena m_arena;
+    FILE* m_in;
+    FILE* m_out;
+    int32_t m_returnValue;
+    uint32_t m_tailCall;            // a CODE_TAIL_CALL to make, or 0
+    std::vector<Slot> m_tailArgs;   // its arguments, on top
+    uint32_t m_depth;
+    uint64_t m_nesting;
+    InterpreterStats m_stats;
+
+    // Profiling; m_calling holds each running function and the call that
+    // entered it
+    struct FunctionCounts
+    {
+        uint64_t calls;
+        uint64_t statements;
+        uint64_t samples;
+    };
+
+    bool m_profiling;
+    int m_profileHz;
+    std::vector<std::pair<const Function*, uint32_t>> m_calling;
+    std::vector<FunctionCounts> m_functionCounts;
+    std::vector<uint64_t> m_trueCounts;     // per node, for CODE_IF and CODE_WHILE
+    std::vector<uint64_t> m_falseCounts;
+    std::map<std::string, uint64_t> m_folded;
+
+    static volatile sig_atomic_t s_sampleDue;
+};
+
+/***********************/
+
+#endif
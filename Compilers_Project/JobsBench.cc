@@ -0,0 +1,120 @@
+/*
+    Filename    : JobsBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parallel Middle End
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************/
+// Local includes
+
+#include "Ast.h"
+#include "BenchClock.h"
+#include "BoundsCheck.h"
+#include "Dataflow.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "WorkStealingPool.h"
+
+/***********************/
+
+// Times the per-function analyses behind --dataflow and --bounds run one
+// function after another, then on a WorkStealingPool of 1, 2, 4, ...
+// threads up to the hardware thread count, and checks every run prints
+// the same thing.
+//   usage: JobsBench file.cm [repetitions]
+
+/***********************/
+
+// What CMinus --dataflow --bounds prints
+static std::vector<std::string>
+analyze (const Ast& ast, const std::vector<Token>& tokens, WorkStealingPool* pool)
+{
+    DataflowStats stats;
+    std::vector<std::string> lines = dataflowWarnings (ast, tokens, stats, pool);
+    std::vector<std::string> bounds = BoundsAnalysis (ast, tokens, pool).report ();
+    lines.insert (lines.end (), bounds.begin (), bounds.end ());
+    return lines;
+}
+
+int
+main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s file.cm [repetitions]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* path = argv[1];
+    int reps = argc > 2 ? std::max (1, atoi (argv[2])) : 5;
+    FILE* srcFile = fopen (path, "r");
+    if (srcFile == NULL)
+    {
+        perror (path);
+        return EXIT_FAILURE;
+    }
+    Lexer lex (srcFile);
+    Parser pars (lex.tokenize ());
+    Ast ast;
+    std::string message = pars.parse (ast);
+    if (!message.empty ())
+    {
+        fprintf (stderr, "%s", message.c_str ());
+        return EXIT_FAILURE;
+    }
+    unsigned functions = 0;
+    for (uint32_t k = 0; k < ast.nodes ()[0].childCount; ++k)
+    {
+        functions += ast.nodes ()[ast.child (0, k)].kind == AST_FUN_DECL;
+    }
+    unsigned hardware = std::max (1u, std::thread::hardware_concurrency ());
+    printf ("%s: %u functions, %d repetitions, %u hardware threads\n", path, functions, reps,
+            hardware);
+
+    std::vector<std::string> expected;
+    std::vector<double> times;
+    for (int i = 0; i < reps; ++i)
+    {
+        auto begin = std::chrono::steady_clock::now ();
+        expected = analyze (ast, pars.m_tokens, NULL);
+        times.push_back (seconds (begin));
+    }
+    std::sort (times.begin (), times.end ());
+    double baseline = times[reps / 2];
+    printf ("%-14s median %8.3fs  %10.0f functions/s\n", "sequential", baseline,
+            functions / baseline);
+
+    for (unsigned threads = 1; threads <= hardware; threads *= 2)
+    {
+        WorkStealingPool pool (threads);
+        times.clear ();
+        for (int i = 0; i < reps; ++i)
+        {
+            auto begin = std::chrono::steady_clock::now ();
+            std::vector<std::string> lines = analyze (ast, pars.m_tokens, &pool);
+            times.push_back (seconds (begin));
+            if (lines != expected)
+            {
+                fprintf (stderr, "%u threads disagree with the sequential run\n", threads);
+                return EXIT_FAILURE;
+            }
+        }
+        std::sort (times.begin (), times.end ());
+        double median = times[reps / 2];
+        printf ("%2u thread(s)    median %8.3fs  %10.0f functions/s  %.2fx  %llu steals\n",
+                threads, median, functions / median, baseline / median,
+                (unsigned long long) pool.steals ());
+    }
+    return EXIT_SUCCESS;
+}
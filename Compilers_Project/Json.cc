@@ -0,0 +1,505 @@
+/*
+    Filename    : Json.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Language Server
+*/
+
+/***********************/
+// System includes
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/***********************/
+// Local includes
+
+#include "Json.h"
+
+/***********************/
+
+namespace
+{
+    class JsonReader
+    {
+    public:
+        JsonReader (const std::string& text)
+            : m_text (text), m_pos (0)
+        { }
+
+        Json
+        document ()
+        {
+            Json value = parseValue ();
+            skipSpace ();
+            if (m_pos != m_text.size ())
+            {
+                fail ("trailing characters");
+            }
+            return value;
+        }
+
+    private:
+        void
+        fail (const char* what)
+        {
+            throw std::runtime_error (std::string ("JSON: ") + what);
+        }
+
+        void
+        skipSpace ()
+        {
+            while (m_pos < m_text.size () && strchr (" \t\r\n", m_text[m_pos]) != NULL)
+            {
+                ++m_pos;
+            }
+        }
+
+        bool
+        consume (const char* literal)
+        {
+            size_t n = strlen (literal);
+            if (m_text.compare (m_pos, n, literal) == 0)
+            {
+                m_pos += n;
+                return true;
+            }
+            return false;
+        }
+
+        Json
+        parseValue ()
+        {
+            skipSpace ();
+            if (m_pos >= m_text.size ())
+            {
+                fail ("unexpected end");
+            }
+            char c = m_text[m_pos];
+            if (c == '{')
+            {
+                return parseObject ();
+            }
+            if (c == '[')
+            {
+                return parseArray ();
+            }
+            if (c == '"')
+            {
+                return Json (parseString ());
+            }
+            if (consume ("true"))
+            {
+                return Json (true);
+            }
+            if (consume ("false"))
+            {
+                return Json (false);
+            }
+            if (consume ("null"))
+            {
+                return Json ();
+            }
+            return parseNumber ();
+        }
+
+        Json
+        parseObject ()
+        {
+            Json object = Json::object ();
+            ++m_pos;
+            skipSpace ();
+            if (consume ("}"))
+            {
+                return object;
+            }
+            while (true)
+            {
+                skipSpace ();
+                if (m_pos >= m_text.size () || m_text[m_pos] != '"')
+                {
+                    fail ("expected member name");
+                }
+                std::string key = parseString ();
+                skipSpace ();
+                if (!consume (":"))
+                {
+                    fail ("expected ':'");
+                }
+                object.set (key, parseValue ());
+                skipSpace ();
+                if (consume ("}"))
+                {
+                    return object;
+                }
+                if (!consume (","))
+                {
+                    fail ("expected ',' or '}'");
+                }
+            }
+        }
+
+        Json
+        parseArray ()
+        {
+            Json array = Json::array ();
+            ++m_pos;
+            skipSpace ();
+            if (consume ("]"))
+            {
+                return array;
+            }
+            while (true)
+            {
+                array.push (parseValue ());
+                skipSpace ();
+                if (consume ("]"))
+                {
+                    return array;
+                }
+                if (!consume (","))
+                {
+                    fail ("expected ',' or ']'");
+                }
+            }
+        }
+
+        void
+        appendUtf8 (std::string& out, unsigned code)
+        {
+            if (code < 0x80)
+            {
+                out.push_back (code);
+            }
+            else if (code < 0x800)
+            {
+                out.push_back (0xC0 | (code >> 6));
+                out.push_back (0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                out.push_back (0xE0 | (code >> 12));
+                out.push_back (0x80 | ((code >> 6) & 0x3F));
+                out.push_back (0x80 | (code & 0x3F));
+            }
+            else
+            {
+                out.push_back (0xF0 | (code >> 18));
+                out.push_back (0x80 | ((code >> 12) & 0x3F));
+                out.push_back (0x80 | ((code >> 6) & 0x3F));
+                out.push_back (0x80 | (code & 0x3F));
+            }
+        }
+
+        unsigned
+        parseHex4 ()
+        {
+            if (m_pos + 4 > m_text.size ())
+            {
+                fail ("bad \\u escape");
+            }
+            unsigned code = strtoul (m_text.substr (m_pos, 4).c_str (), NULL, 16);
+            m_pos += 4;
+            return code;
+        }
+
+        std::string
+        parseString ()
+        {
+            std::string out;
+            ++m_pos;
+            while (true)
+            {
+                if (m_pos >= m_text.size ())
+                {
+                    fail ("unterminated string");
+                }
+                char c = m_text[m_pos++];
+                if (c == '"')
+                {
+                    return out;
+                }
+                if (c != '\\')
+                {
+                    out.push_back (c);
+                    continue;
+                }
+                if (m_pos >= m_text.size ())
+                {
+                    fail ("unterminated string");
+                }
+                c = m_text[m_pos++];
+                switch (c)
+                {
+                    case 'n': out.push_back ('\n'); break;
+                    case 't': out.push_back ('\t'); break;
+                    case 'r': out.push_back ('\r'); break;
+                    case 'b': out.push_back ('\b'); break;
+                    case 'f': out.push_back ('\f'); break;
+                    case 'u':
+                    {
+                        unsigned code = parseHex4 ();
+                        if (code >= 0xD800 && code < 0xDC00 && consume ("\\u"))
+                        {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (parseHex4 () - 0xDC00);
+                        }
+                        appendUtf8 (out, code);
+                        break;
+                    }
+                    default: out.push_back (c); break;
+                }
+            }
+        }
+
+        Json
+        parseNumber ()
+        {
+            const char* begin = m_text.c_str () + m_pos;
+            char* end;
+            double value = strtod (begin, &end);
+            if (end == begin)
+            {
+                fail ("unexpected character");
+            }
+            m_pos += end - begin;
+            return Json (value);
+        }
+
+    private:
+        const std::string& m_text;
+        size_t m_pos;
+    };
+
+    void
+    dumpString (std::string& out, const std::string& value)
+    {
+        out.push_back ('"');
+        for (unsigned char c : value)
+        {
+            switch (c)
+            {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                case '\r': out += "\\r"; break;
+                default:
+                    if (c < 0x20)
+                    {
+                        char buffer[8];
+                        snprintf (buffer, sizeof (buffer), "\\u%04x", c);
+                        out += buffer;
+                    }
+                    else
+                    {
+                        out.push_back (c);
+                    }
+            }
+        }
+        out.push_back ('"');
+    }
+}
+
+/***********************/
+
+Json::Json ()
+    : m_kind (NUL), m_bool (false), m_number (0)
+{
+}
+
+Json::Json (bool value)
+    : m_kind (BOOLEAN), m_bool (value), m_number (0)
+{
+}
+
+Json::Json (int value)
+    : m_kind (NUMBER), m_bool (false), m_number (value)
+{
+}
+
+Json::Json (double value)
+    : m_kind (NUMBER), m_bool (false), m_number (value)
+{
+}
+
+Json::Json (const char* value)
+    : m_kind (STRING), m_bool (false), m_number (0), m_string (value)
+{
+}
+
+Json::Json (const std::string& value)
+    : m_kind (STRING), m_bool (false), m_number (0), m_string (value)
+{
+}
+
+Json
+Json::array ()
+{
+    Json value;
+    value.m_kind = ARRAY;
+    return value;
+}
+
+Json
+Json::object ()
+{
+    Json value;
+    value.m_kind = OBJECT;
+    return value;
+}
+
+Json
+Json::parse (const std::string& text)
+{
+    JsonReader reader (text);
+    return reader.document ();
+}
+
+std::string
+Json::dump () const
+{
+    std::string out;
+    dumpTo (out);
+    return out;
+}
+
+Json::Kind
+Json::kind () const
+{
+    return m_kind;
+}
+
+bool
+Json::isNull () const
+{
+    return m_kind == NUL;
+}
+
+bool
+Json::asBool () const
+{
+    return m_bool;
+}
+
+double
+Json::asNumber () const
+{
+    return m_number;
+}
+
+int
+Json::asInt () const
+{
+    return (int) m_number;
+}
+
+const std::string&
+Json::asString () const
+{
+    return m_string;
+}
+
+const Json&
+Json::operator[] (const std::string& key) const
+{
+    static const Json null;
+    for (const std::pair<std::string, Json>& member : m_members)
+    {
+        if (member.first == key)
+        {
+            return member.second;
+        }
+    }
+    return null;
+}
+
+Json&
+Json::set (const std::string& key, const Json& value)
+{
+    for (std::pair<std::string, Json>& member : m_members)
+    {
+        if (member.first == key)
+        {
+            member.second = value;
+            return *this;
+        }
+    }
+    m_members.push_back (std::make_pair (key, value));
+    return *this;
+}
+
+const std::vector<Json>&
+Json::elements () const
+{
+    return m_elements;
+}
+
+void
+Json::push (const Json& value)
+{
+    m_elements.push_back (value);
+}
+
+void
+Json::dumpTo (std::string& out) const
+{
+    switch (m_kind)
+    {
+        case NUL:
+            out += "null";
+            break;
+
+        case BOOLEAN:
+            out += m_bool ? "true" : "false";
+            break;
+
+        case NUMBER:
+        {
+            char buffer[32];
+            if (m_number == std::floor (m_number) && std::fabs (m_number) < 1e15)
+            {
+                snprintf (buffer, sizeof (buffer), "%lld", (long long) m_number);
+            }
+            else
+            {
+                snprintf (buffer, sizeof (buffer), "%.17g", m_number);
+            }
+            out += buffer;
+            break;
+        }
+
+        case STRING:
+            dumpString (out, m_string);
+            break;
+
+        case ARRAY:
+            out.push_back ('[');
+            for (size_t i = 0; i < m_elements.size (); ++i)
+            {
+                if (i > 0)
+                {
+                    out.push_back (',');
+                }
+                m_elements[i].dumpTo (out);
+            }
+            out.push_back (']');
+            break;
+
+        case OBJECT:
+            out.push_back ('{');
+            for (size_t i = 0; i < m_members.size (); ++i)
+            {
+                if (i > 0)
+                {
+                    out.push_back (',');
+                }
+                dumpString (out, m_members[i].first);
+                out.push_back (':');
+                m_members[i].second.dumpTo (out);
+            }
+            out.push_back ('}');
+            break;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+    Filename    : Json.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Language Server
+*/
+
+/***********************/
+
+#ifndef JSON_H
+#define JSON_H
+
+/***********************/
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/***********************/
+
+// Just enough JSON for the language server's JSON-RPC messages
+class Json
+{
+public:
+    enum Kind
+    {
+        NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT
+    };
+
+    Json ();
+
+    Json (bool value);
+
+    Json (int value);
+
+    Json (double value);
+
+    Json (const char* value);
+
+    Json (const std::string& value);
+
+    static Json
+    array ();
+
+    static Json
+    object ();
+
+    // Throws std::runtime_error on malformed text
+    static Json
+    parse (const std::string& text);
+
+    std::string
+    dump () const;
+
+    Kind
+    kind () const;
+
+    bool
+    isNull () const;
+
+    bool
+    asBool () const;
+
+    double
+    asNumber () const;
+
+    int
+    asInt () const;
+
+    const std::string&
+    asString () const;
+
+    // Member lookup; a missing member (or a non-object) gives null
+    const Json&
+    operator[] (const std::string& key) const;
+
+    // Adds or replaces a member, returning *this for chaining
+    Json&
+    set (const std::string& key, const Json& value);
+
+    const std::vector<Json>&
+    elements () const;
+
+    void
+    push (const Json& value);
+
+private:
+    void
+    dumpTo (std::string& out) const;
+
+private:
+    Kind m_kind;
+    bool m_bool;
+    double m_number;
+    std::string m_string;
+    std::vector<Json> m_elements;
+    std::vector<std::pair<std::string, Json>> m_members;
+};
+
+/***********************/
+
+#endif
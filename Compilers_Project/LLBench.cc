@@ -0,0 +1,92 @@
+/*
+    Filename    : LLBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Table-Driven Parser
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/***********************/
+// Local includes
+
+#include "LLParser.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+/***********************/
+
+// Times the recursive-descent Parser against the table-driven LLParser
+// on the same token stream. Lexing happens once, outside the timings.
+// Both parsers must accept the input.
+//   usage: LLBench file.cm [repetitions]
+
+/***********************/
+
+template<class P>
+static double
+run (const std::vector<Token>& tokens, const char* name)
+{
+    P pars (tokens);
+    auto begin = std::chrono::steady_clock::now ();
+    std::string message = pars.check ();
+    auto end = std::chrono::steady_clock::now ();
+    if (!message.empty ())
+    {
+        fprintf (stderr, "%s rejected the input:%s", name, message.c_str ());
+        exit (1);
+    }
+    return std::chrono::duration<double> (end - begin).count ();
+}
+
+static void
+report (const char* name, std::vector<double>& times, size_t tokens)
+{
+    std::sort (times.begin (), times.end ());
+    double median = times[times.size () / 2];
+    printf ("%-18s min %8.3fs  median %8.3fs  %8.1f Mtokens/s\n", name,
+            times.front (), median, tokens / median / 1e6);
+}
+
+int
+main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s file.cm [repetitions]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* path = argv[1];
+    int reps = argc > 2 ? std::max (1, atoi (argv[2])) : 5;
+
+    FILE* srcFile = fopen (path, "r");
+    if (srcFile == NULL)
+    {
+        perror (path);
+        return EXIT_FAILURE;
+    }
+    Lexer lex (srcFile);
+    std::vector<Token> tokens = lex.tokenize ();
+    printf ("%s: %zu tokens, %d repetitions\n", path, tokens.size (), reps);
+
+    std::vector<double> descent;
+    std::vector<double> table;
+    for (int i = 0; i < reps; ++i)
+    {
+        descent.push_back (run<Parser> (tokens, "Parser"));
+        table.push_back (run<LLParser> (tokens, "LLParser"));
+    }
+    report ("recursive descent", descent, tokens.size ());
+    report ("LL(1) table", table, tokens.size ());
+
+    printf ("speedup            %.2fx\n", descent[reps / 2] / table[reps / 2]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/*
+    Filename    : LLParser.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Table-Driven Parser
+*/
+
+/***********************/
+// System includes
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "LLParser.h"
+#include "LLTable.h"
+
+/***********************/
+
+// A stack entry is a grammar symbol in the low 16 bits and, above it,
+// the nonterminal whose production pushed it, for error messages
+static inline uint32_t
+entry (int symbol, int owner)
+{
+    return (uint32_t) owner << 16 | symbol;
+}
+
+/***********************/
+
+LLParser::LLParser (std::vector<Token> tokenVector)
+    : m_tokens (std::move (tokenVector)), m_index (0)
+{
+}
+
+LLParser::~LLParser ()
+{
+}
+
+void
+LLParser::parse ()
+{
+    // The stack grows only by whole right-hand sides, so one capacity check
+    // per expansion is enough. The loop works on locals; m_index is kept
+    // up to date for error reporting.
+    std::vector<uint32_t> stack (256);
+    uint32_t* base = stack.data ();
+    uint32_t* top = base;
+    *top++ = entry (LL_START, LL_START);
+    const Token* token = &m_tokens[m_index];
+    TokenType t = token->type;
+    while (top != base)
+    {
+        uint32_t e = *--top;
+        int symbol = e & 0xffff;
+
+        if (symbol < LL_TERMINALS)
+        {
+            if (t != symbol)
+            {
+                m_index = token - m_tokens.data ();
+                throw ParseError (LL_NAMES[(e >> 16) - LL_TERMINALS], (TokenType) symbol, m_index);
+            }
+            if (t != END_OF_FILE)
+            {
+                t = (++token)->type;
+            }
+            continue;
+        }
+
+        int production = LL_TABLE[symbol - LL_TERMINALS][t] - 1;
+        if (production < 0)
+        {
+            m_index = token - m_tokens.data ();
+            throw ParseError (LL_NAMES[symbol - LL_TERMINALS],
+                              LL_EXPECTED[symbol - LL_TERMINALS], m_index);
+        }
+        if (top + LL_MAX_RHS > base + stack.size ())
+        {
+            size_t used = top - base;
+            stack.resize (stack.size () * 2);
+            base = stack.data ();
+            top = base + used;
+        }
+        for (int i = LL_RHS_START[production]; i < LL_RHS_START[production + 1]; ++i)
+        {
+            *top++ = entry (LL_RHS[i], symbol);
+        }
+    }
+    m_index = token - m_tokens.data ();
+}
+
+std::string
+LLParser::check ()
+{
+    try
+    {
+        parse ();
+    }
+    catch (const ParseError& e)
+    {
+        return describe (e);
+    }
+    return "";
+}
+
+// Prints "Valid!" or the first error; an invalid program exits with
+// status 1
+void
+LLParser::start ()
+{
+    std::string message = check ();
+    if (!message.empty ())
+    {
+        printf ("%s", message.c_str ());
+        exit (1);
+    }
+    printf ("Valid!\n");
+}
+
+std::string
+LLParser::describe (const ParseError& e)
+{
+    return ::describe (m_tokens, e);
+}
@@ -0,0 +1,60 @@
+/*
+    Filename    : LLParser.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Table-Driven Parser
+*/
+
+/***********************/
+
+#ifndef LL_PARSER_H
+#define LL_PARSER_H
+
+/***********************/
+
+#include <string>
+#include <vector>
+
+#include "Lexer.h"
+#include "Parser.h"
+
+/***********************/
+
+// Table-driven LL(1) parser with the same entry points as Parser. The
+// table comes from CMinus.grammar through GrammarGen; the driver keeps
+// its own symbol stack, so nesting depth is limited only by memory.
+//
+// It parses the grammar as written, which is slightly stricter than the
+// recursive-descent Parser: that one lets typeSpecifier, params, relop,
+// addop, mulop and factor match nothing. Errors are reported as ParseErrors
+// naming the nonterminal being expanded (or the one that pushed the
+// mismatched token) and printed in Parser's format.
+class LLParser
+{
+public:
+    LLParser (std::vector<Token> tokenVector);
+
+    ~LLParser ();
+
+    // Parses the whole input and returns the diagnostic start () would
+    // print for it, or "" if the program is valid
+    std::string
+    check ();
+
+    void
+    start ();
+
+    std::string
+    describe (const ParseError& e);
+
+    void
+    parse ();
+
+public:
+    std::vector<Token> m_tokens;
+    int m_index;
+};
+
+/***********************/
+
+#endif
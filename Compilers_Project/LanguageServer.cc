@@ -0,0 +1,525 @@
+/*
+    Filename    : LanguageServer.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Language Server
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+/***********************/
+// Local includes
+
+#include "LanguageServer.h"
+
+/***********************/
+
+// JSON-RPC error codes
+static const int PARSE_ERROR = -32700;
+static const int INVALID_REQUEST = -32600;
+static const int INVALID_PARAMS = -32602;
+static const int METHOD_NOT_FOUND = -32601;
+
+// The largest message body read into memory
+static const long MAX_MESSAGE_BYTES = 64L << 20;
+
+namespace
+{
+    struct RpcError
+    {
+        int code;
+        std::string message;
+    };
+
+    std::string
+    uriToPath (const std::string& uri)
+    {
+        std::string path = uri.compare (0, 7, "file://") == 0 ? uri.substr (7) : uri;
+        std::string decoded;
+        for (size_t i = 0; i < path.size (); ++i)
+        {
+            if (path[i] == '%' && i + 2 < path.size ())
+            {
+                decoded.push_back (strtol (path.substr (i + 1, 2).c_str (), NULL, 16));
+                i += 2;
+            }
+            else
+            {
+                decoded.push_back (path[i]);
+            }
+        }
+        return decoded;
+    }
+
+    bool
+    readFile (const std::string& path, std::string& text)
+    {
+        FILE* srcFile = fopen (path.c_str (), "r");
+        if (srcFile == NULL)
+        {
+            return false;
+        }
+        text.clear ();
+        char buffer[1 << 16];
+        size_t n;
+        while ((n = fread (buffer, 1, sizeof (buffer), srcFile)) > 0)
+        {
+            text.append (buffer, n);
+        }
+        fclose (srcFile);
+        return true;
+    }
+
+    // LSP positions are 0-based lines and characters
+    int
+    offsetOf (const std::string& text, int line, int character)
+    {
+        size_t start = 0;
+        for (int i = 0; i < line; ++i)
+        {
+            size_t newline = text.find ('\n', start);
+            if (newline == std::string::npos)
+            {
+                return text.size ();
+            }
+            start = newline + 1;
+        }
+        size_t end = text.find ('\n', start);
+        if (end == std::string::npos)
+        {
+            end = text.size ();
+        }
+        return std::min (start + std::max (character, 0), end);
+    }
+
+    Json
+    positionOf (const std::string& text, int offset)
+    {
+        int line = std::count (text.begin (), text.begin () + offset, '\n');
+        size_t lineStart = offset == 0 ? std::string::npos : text.rfind ('\n', offset - 1);
+        int character = lineStart == std::string::npos ? offset : offset - lineStart - 1;
+        return Json::object ().set ("line", line).set ("character", character);
+    }
+
+    // Parser::describe's multi-line diagnostic as one line
+    std::string
+    oneLine (const std::string& message)
+    {
+        std::string out;
+        size_t pos = 0;
+        while (pos < message.size ())
+        {
+            size_t end = message.find ('\n', pos);
+            if (end == std::string::npos)
+            {
+                end = message.size ();
+            }
+            std::string line = message.substr (pos, end - pos);
+            size_t first = line.find_first_not_of (" \t");
+            if (first != std::string::npos)
+            {
+                if (!out.empty ())
+                {
+                    out += "; ";
+                }
+                out += line.substr (first);
+            }
+            pos = end + 1;
+        }
+        return out;
+    }
+}
+
+/***********************/
+
+LanguageServer::LanguageServer (FILE* in, FILE* out)
+    : m_in (in), m_out (out), m_shutdown (false)
+{
+}
+
+LanguageServer::~LanguageServer ()
+{
+}
+
+int
+LanguageServer::run ()
+{
+    std::string body;
+    while (readMessage (body))
+    {
+        Json message;
+        try
+        {
+            message = Json::parse (body);
+        }
+        catch (const std::runtime_error& e)
+        {
+            respondError (Json (), PARSE_ERROR, e.what ());
+            continue;
+        }
+        if (!handle (message))
+        {
+            return m_shutdown ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+// A Content-Length that is not a number or is over MAX_MESSAGE_BYTES
+// gets an error response, and the body it announces is skipped, so the
+// next message is still found
+bool
+LanguageServer::readMessage (std::string& body)
+{
+    long length = -1;
+    bool bad = false;
+    char line[256];
+    while (fgets (line, sizeof (line), m_in) != NULL)
+    {
+        if (strcmp (line, "\r\n") == 0 || strcmp (line, "\n") == 0)
+        {
+            if (bad)
+            {
+                respondError (Json (), INVALID_REQUEST, "Content-Length must be a number of bytes up to 64MB");
+                for (char buffer[1 << 16]; length > 0; )
+                {
+                    size_t n = fread (buffer, 1, std::min (length, (long) sizeof (buffer)), m_in);
+                    if (n == 0)
+                    {
+                        return false;
+                    }
+                    length -= n;
+                }
+                length = -1;
+                bad = false;
+                continue;
+            }
+            if (length < 0)
+            {
+                continue;
+            }
+            body.resize (length);
+            return fread (&body[0], 1, length, m_in) == (size_t) length;
+        }
+        if (strncasecmp (line, "Content-Length:", 15) == 0)
+        {
+            char* end;
+            errno = 0;
+            length = strtol (line + 15, &end, 10);
+            while (isspace ((unsigned char) *end))
+            {
+                ++end;
+            }
+            bad = end == line + 15 || *end != '\0' || errno != 0 || length < 0 ||
+                  length > MAX_MESSAGE_BYTES;
+        }
+    }
+    return false;
+}
+
+void
+LanguageServer::send (const Json& message)
+{
+    std::string body = message.dump ();
+    fprintf (m_out, "Content-Length: %zu\r\n\r\n", body.size ());
+    fwrite (body.data (), 1, body.size (), m_out);
+    fflush (m_out);
+}
+
+void
+LanguageServer::respond (const Json& id, const Json& result)
+{
+    send (Json::object ().set ("jsonrpc", "2.0").set ("id", id).set ("result", result));
+}
+
+void
+LanguageServer::respondError (const Json& id, int code, const std::string& message)
+{
+    Json error = Json::object ().set ("code", code).set ("message", message);
+    send (Json::object ().set ("jsonrpc", "2.0").set ("id", id).set ("error", error));
+}
+
+void
+LanguageServer::notify (const std::string& method, const Json& params)
+{
+    send (Json::object ().set ("jsonrpc", "2.0").set ("method", method).set ("params", params));
+}
+
+bool
+LanguageServer::handle (const Json& message)
+{
+    const std::string& method = message["method"].asString ();
+    const Json& id = message["id"];
+    if (method == "exit")
+    {
+        return false;
+    }
+    try
+    {
+        Json result = dispatch (method, message["params"]);
+        if (!id.isNull ())
+        {
+            respond (id, result);
+        }
+    }
+    catch (const RpcError& e)
+    {
+        if (!id.isNull ())
+        {
+            respondError (id, e.code, e.message);
+        }
+    }
+    return true;
+}
+
+Json
+LanguageServer::dispatch (const std::string& method, const Json& params)
+{
+    if (method == "initialize")
+    {
+        Json capabilities = Json::object ()
+            .set ("textDocumentSync", 2)   // incremental
+            .set ("definitionProvider", true)
+            .set ("diagnosticProvider", Json::object ()
+                  .set ("interFileDependencies", false)
+                  .set ("workspaceDiagnostics", false));
+        return Json::object ()
+            .set ("capabilities", capabilities)
+            .set ("serverInfo", Json::object ().set ("name", "cminus"));
+    }
+    if (method == "shutdown")
+    {
+        m_shutdown = true;
+        return Json ();
+    }
+    if (method == "textDocument/didOpen")
+    {
+        const Json& item = params["textDocument"];
+        const std::string& uri = item["uri"].asString ();
+        Document& doc = m_documents[uri];
+        doc.open = true;
+        setText (doc, item["text"].asString ());
+        publishDiagnostics (uri, doc);
+        return Json ();
+    }
+    if (method == "textDocument/didChange")
+    {
+        const std::string& uri = params["textDocument"]["uri"].asString ();
+        std::map<std::string, Document>::iterator found = m_documents.find (uri);
+        if (found == m_documents.end () || !found->second.parser)
+        {
+            throw RpcError { INVALID_PARAMS, "document is not open: " + uri };
+        }
+        Document& doc = found->second;
+        for (const Json& change : params["contentChanges"].elements ())
+        {
+            const Json& range = change["range"];
+            if (range.isNull ())
+            {
+                setText (doc, change["text"].asString ());
+                continue;
+            }
+            const std::string& text = doc.parser->text ();
+            int begin = offsetOf (text, range["start"]["line"].asInt (),
+                                  range["start"]["character"].asInt ());
+            int end = offsetOf (text, range["end"]["line"].asInt (),
+                                range["end"]["character"].asInt ());
+            doc.parser->edit (begin, std::max (begin, end), change["text"].asString ());
+            doc.symbols.reset ();
+        }
+        publishDiagnostics (uri, doc);
+        return Json ();
+    }
+    if (method == "textDocument/didClose")
+    {
+        // Forget the editor's copy; the next request re-reads the file
+        m_documents.erase (params["textDocument"]["uri"].asString ());
+        return Json ();
+    }
+    if (method == "textDocument/diagnostic")
+    {
+        Document* doc = document (params["textDocument"]["uri"].asString ());
+        if (doc == NULL)
+        {
+            throw RpcError { INVALID_PARAMS, "cannot read document" };
+        }
+        return Json::object ().set ("kind", "full").set ("items", diagnostics (*doc));
+    }
+    if (method == "textDocument/definition")
+    {
+        return definition (params);
+    }
+    if (method == "cminus/validate")
+    {
+        return validate (params);
+    }
+    if (method == "initialized" || method.compare (0, 2, "$/") == 0)
+    {
+        return Json ();
+    }
+    throw RpcError { METHOD_NOT_FOUND, "unknown method: " + method };
+}
+
+// The document for uri: the editor's copy if it is open, otherwise the
+// file on disk, read again only if its size or mtime changed
+LanguageServer::Document*
+LanguageServer::document (const std::string& uri)
+{
+    std::map<std::string, Document>::iterator found = m_documents.find (uri);
+    if (found != m_documents.end () && found->second.open)
+    {
+        return &found->second;
+    }
+
+    std::string path = uriToPath (uri);
+    struct stat info;
+    if (stat (path.c_str (), &info) != 0)
+    {
+        return NULL;
+    }
+    if (found != m_documents.end () && found->second.size == info.st_size &&
+        found->second.mtime.tv_sec == info.st_mtim.tv_sec &&
+        found->second.mtime.tv_nsec == info.st_mtim.tv_nsec)
+    {
+        return &found->second;
+    }
+
+    std::string text;
+    if (!readFile (path, text))
+    {
+        return NULL;
+    }
+    Document& doc = m_documents[uri];
+    doc.open = false;
+    doc.size = info.st_size;
+    doc.mtime = info.st_mtim;
+    setText (doc, text);
+    return &doc;
+}
+
+// Applies a whole new text as one edit covering what changed between
+// the common prefix and suffix, so rewrites of a file stay incremental
+void
+LanguageServer::setText (Document& doc, const std::string& text)
+{
+    doc.symbols.reset ();
+    if (!doc.parser)
+    {
+        doc.parser.reset (new IncrementalParser (text));
+        return;
+    }
+    const std::string& old = doc.parser->text ();
+    size_t limit = std::min (old.size (), text.size ());
+    size_t prefix = 0;
+    while (prefix < limit && old[prefix] == text[prefix])
+    {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < limit - prefix &&
+           old[old.size () - 1 - suffix] == text[text.size () - 1 - suffix])
+    {
+        ++suffix;
+    }
+    if (prefix == old.size () && prefix == text.size ())
+    {
+        return;
+    }
+    doc.parser->edit (prefix, old.size () - suffix,
+                      text.substr (prefix, text.size () - suffix - prefix));
+}
+
+void
+LanguageServer::publishDiagnostics (const std::string& uri, Document& doc)
+{
+    notify ("textDocument/publishDiagnostics",
+            Json::object ().set ("uri", uri).set ("diagnostics", diagnostics (doc)));
+}
+
+Json
+LanguageServer::diagnostics (Document& doc)
+{
+    Json items = Json::array ();
+    for (const ParseError& e : doc.parser->errors ())
+    {
+        items.push (Json::object ()
+                    .set ("range", range (doc, e.index))
+                    .set ("severity", 1)
+                    .set ("source", "cminus")
+                    .set ("message", oneLine (doc.parser->describe (e))));
+    }
+    return items;
+}
+
+Json
+LanguageServer::range (Document& doc, int tokenIndex)
+{
+    const Token& t = doc.parser->tokens ()[tokenIndex];
+    const std::string& text = doc.parser->text ();
+    return Json::object ()
+        .set ("start", positionOf (text, t.offset))
+        .set ("end", positionOf (text, t.offset + t.lexeme.size ()));
+}
+
+Json
+LanguageServer::validate (const Json& params)
+{
+    std::string uri = params["uri"].asString ();
+    if (uri.empty ())
+    {
+        uri = "file://" + params["path"].asString ();
+    }
+    Document* doc = document (uri);
+    if (doc == NULL)
+    {
+        throw RpcError { INVALID_PARAMS, "cannot read " + uriToPath (uri) };
+    }
+    bool valid = doc->parser->valid ();
+    return Json::object ()
+        .set ("valid", valid)
+        .set ("message", valid ? std::string ("Valid!\n") : doc->parser->firstError ());
+}
+
+Json
+LanguageServer::definition (const Json& params)
+{
+    const std::string& uri = params["textDocument"]["uri"].asString ();
+    Document* doc = document (uri);
+    if (doc == NULL)
+    {
+        return Json ();
+    }
+    const std::vector<Token>& tokens = doc->parser->tokens ();
+    int offset = offsetOf (doc->parser->text (), params["position"]["line"].asInt (),
+                           params["position"]["character"].asInt ());
+
+    // The identifier under the cursor, or the one just before it
+    int i = std::upper_bound (tokens.begin (), tokens.end (), offset,
+                              [] (int off, const Token& t) {
+                                  return off < t.offset;
+                              }) - tokens.begin () - 1;
+    if (i < 0 || tokens[i].type != ID ||
+        offset > tokens[i].offset + (int) tokens[i].lexeme.size ())
+    {
+        return Json ();
+    }
+
+    if (!doc->symbols)
+    {
+        doc->symbols.reset (new SymbolTable (tokens));
+    }
+    int declared = doc->symbols->definition (i);
+    if (declared < 0)
+    {
+        return Json ();
+    }
+    return Json::object ().set ("uri", uri).set ("range", range (*doc, declared));
+}
@@ -0,0 +1,114 @@
+/*
+    Filename    : LanguageServer.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Language Server
+*/
+
+/***********************/
+
+#ifndef LANGUAGE_SERVER_H
+#define LANGUAGE_SERVER_H
+
+/***********************/
+
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+#include "IncrementalParser.h"
+#include "Json.h"
+#include "SymbolTable.h"
+
+/***********************/
+
+// Long-running C-Minus server speaking JSON-RPC with LSP framing
+// ("Content-Length: N\r\n\r\n" + body). Documents stay resident: files
+// the editor has open are kept up to date from didOpen/didChange, and
+// files only read from disk are cached by path and re-read only when
+// their size or modification time changes. Either way a change goes
+// through IncrementalParser, and the SymbolTable is rebuilt lazily.
+//
+// Requests: initialize, shutdown, textDocument/definition,
+// textDocument/diagnostic and cminus/validate ({uri} or {path}, answers
+// {valid, message} with the text CMinus would print).
+// Notifications: initialized, exit, textDocument/didOpen, didChange
+// (full or ranged) and didClose. Diagnostics are published after every
+// open and change.
+class LanguageServer
+{
+public:
+    LanguageServer (FILE* in, FILE* out);
+
+    ~LanguageServer ();
+
+    // Serves until "exit" or end of input; returns the exit status
+    int
+    run ();
+
+private:
+    struct Document
+    {
+        std::unique_ptr<IncrementalParser> parser;
+        std::unique_ptr<SymbolTable> symbols;
+        bool open;
+        off_t size;
+        struct timespec mtime;
+    };
+
+    bool
+    readMessage (std::string& body);
+
+    void
+    send (const Json& message);
+
+    void
+    respond (const Json& id, const Json& result);
+
+    void
+    respondError (const Json& id, int code, const std::string& message);
+
+    void
+    notify (const std::string& method, const Json& params);
+
+    // Returns false once "exit" has been handled
+    bool
+    handle (const Json& message);
+
+    Json
+    dispatch (const std::string& method, const Json& params);
+
+    Document*
+    document (const std::string& uri);
+
+    void
+    setText (Document& doc, const std::string& text);
+
+    void
+    publishDiagnostics (const std::string& uri, Document& doc);
+
+    Json
+    diagnostics (Document& doc);
+
+    Json
+    validate (const Json& params);
+
+    Json
+    definition (const Json& params);
+
+    Json
+    range (Document& doc, int tokenIndex);
+
+private:
+    FILE* m_in;
+    FILE* m_out;
+    bool m_shutdown;
+    std::map<std::string, Document> m_documents;
+};
+
+/***********************/
+
+#endif
@@ -0,0 +1,154 @@
+/*
+    Filename    : LexBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parallel Lexing
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+/***********************/
+// Local includes
+
+#include "BenchClock.h"
+#include "Lexer.h"
+#include "ParallelLexer.h"
+
+/***********************/
+
+// Times Lexer::tokenize against parallelTokenize at 1, 2, 4, ... threads
+// up to the hardware thread count, and checks the token streams match.
+// Also counts the heap allocations one Lexer::tokenize makes.
+//   usage: LexBench file.cm [repetitions]
+
+/***********************/
+
+static std::atomic<size_t> g_allocations (0);
+
+void*
+operator new (size_t size)
+{
+    ++g_allocations;
+    void* p = malloc (size > 0 ? size : 1);
+    if (p == NULL)
+    {
+        throw std::bad_alloc ();
+    }
+    return p;
+}
+
+void
+operator delete (void* p) noexcept
+{
+    free (p);
+}
+
+void
+operator delete (void* p, size_t) noexcept
+{
+    free (p);
+}
+
+/***********************/
+
+static bool
+sameTokens (const std::vector<Token>& a, const std::vector<Token>& b)
+{
+    if (a.size () != b.size ())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size (); ++i)
+    {
+        if (a[i].type != b[i].type || a[i].lexeme != b[i].lexeme ||
+            a[i].number != b[i].number || a[i].line != b[i].line ||
+            a[i].column != b[i].column || a[i].offset != b[i].offset)
+        {
+            fprintf (stderr, "token %zu differs: \"%s\" %d:%d vs \"%s\" %d:%d\n", i,
+                     a[i].lexeme.c_str (), a[i].line, a[i].column,
+                     b[i].lexeme.c_str (), b[i].line, b[i].column);
+            return false;
+        }
+    }
+    return true;
+}
+
+int
+main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s file.cm [repetitions]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* path = argv[1];
+    int reps = argc > 2 ? std::max (1, atoi (argv[2])) : 5;
+
+    struct stat info;
+    if (stat (path, &info) != 0)
+    {
+        perror (path);
+        return EXIT_FAILURE;
+    }
+    double mb = info.st_size / (1024.0 * 1024.0);
+    unsigned hardware = std::max (1u, std::thread::hardware_concurrency ());
+    printf ("%s: %.1f MB, %d repetitions, %u hardware threads\n", path, mb, reps, hardware);
+
+    std::vector<Token> expected;
+    std::vector<double> times;
+    for (int i = 0; i < reps; ++i)
+    {
+        auto begin = std::chrono::steady_clock::now ();
+        Lexer lex (fopen (path, "r"));
+        expected = lex.tokenize ();
+        times.push_back (seconds (begin));
+    }
+    std::sort (times.begin (), times.end ());
+    double baseline = times[reps / 2];
+    printf ("%-14s median %8.3fs  %8.1f MB/s  %10.0f tokens/s\n", "tokenize",
+            baseline, mb / baseline, expected.size () / baseline);
+
+    {
+        Lexer lex (fopen (path, "r"));
+        size_t before = g_allocations.load ();
+        std::vector<Token> tokens = lex.tokenize ();
+        size_t allocations = g_allocations.load () - before;
+        const LexStats& stats = lex.stats ();
+        printf ("%-14s %zu allocations: estimate %zu tokens for %zu (%.1f%% over), "
+                "%zu reallocations, %zu long lexemes\n", "", allocations, stats.estimate,
+                stats.tokens, 100.0 * (stats.estimate - stats.tokens) / stats.tokens,
+                stats.reallocations, stats.lexemeAllocations);
+    }
+
+    for (unsigned threads = 1; threads <= hardware; threads *= 2)
+    {
+        times.clear ();
+        for (int i = 0; i < reps; ++i)
+        {
+            auto begin = std::chrono::steady_clock::now ();
+            std::vector<Token> tokens = parallelTokenize (fopen (path, "r"), threads);
+            times.push_back (seconds (begin));
+            if (!sameTokens (expected, tokens))
+            {
+                fprintf (stderr, "parallelTokenize (%u threads) disagrees with tokenize\n", threads);
+                return EXIT_FAILURE;
+            }
+        }
+        std::sort (times.begin (), times.end ());
+        double median = times[reps / 2];
+        printf ("%2u thread(s)    median %8.3fs  %8.1f MB/s  %10.0f tokens/s  %.2fx\n",
+                threads, median, mb / median, expected.size () / median, baseline / median);
+    }
+    return EXIT_SUCCESS;
+}
@@ -8,15 +8,19 @@
 /***********************/
 // System includes
 
+#include <cerrno>
+#include <climits>
 #include <cstdlib>
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <sys/stat.h>
 
 /***********************/
 // Local includes
 
 #include "Lexer.h"
+#include "TokenQueue.h"
 
 /***********************/
 // Using declarations
@@ -24,33 +28,79 @@
 using std::cout;
 using std::endl;
 using std::string;
-using std::stoi; 
 
 /***********************/
 Lexer::Lexer (FILE* srcFile)
 {
     m_lineNum = 1;
     m_columnNum = 1;
+    m_offset = 0;
+    m_tokenStart = 0;
     m_srcFile = srcFile;
+    m_cursor = NULL;
+    m_end = NULL;
+    m_inComment = false;
+    m_stats = LexStats ();
     //fopen(m_srcFile, "r");
 }
 
+Lexer::Lexer (const char* begin, size_t size, bool inComment)
+{
+    m_lineNum = 1;
+    m_columnNum = inComment ? 0 : 1;
+    m_offset = 0;
+    m_tokenStart = 0;
+    m_srcFile = NULL;
+    m_cursor = begin;
+    m_end = begin + size;
+    m_inComment = inComment;
+    m_stats = LexStats ();
+}
+
 Lexer::~Lexer ()
 {
-    fclose (m_srcFile);
+    if (m_srcFile != NULL)
+    {
+        fclose (m_srcFile);
+    }
 }
 
 int
 Lexer::getChar ()
 {
     ++m_columnNum;
-    return fgetc (m_srcFile);
+    if (m_srcFile == NULL)
+    {
+        if (m_cursor == m_end)
+        {
+            return EOF;
+        }
+        ++m_offset;
+        return (unsigned char) *m_cursor++;
+    }
+    int c = fgetc (m_srcFile);
+    if (c != EOF)
+    {
+        ++m_offset;
+    }
+    return c;
 }
 
+// Like ungetc, pushing back EOF is a no-op
 void
 Lexer::ungetChar (int c)
 {
     --m_columnNum;
+    if (c == EOF)
+    {
+        return;
+    }
+    --m_offset;
+    if (m_srcFile == NULL)
+    {
+        --m_cursor;
+        return;
+    }
     ungetc (c, m_srcFile);
 }
 
@@ -69,22 +119,128 @@ Lexer::getColumnNum()
 std::vector <Token>
 Lexer::tokenize ()
 {
+    load ();
+    m_stats = LexStats ();
+    m_stats.bytes = m_end - m_cursor;
+    m_stats.estimate = estimateTokens (m_cursor, m_end - m_cursor);
     std::vector<Token> tokenVector;
+    tokenVector.reserve (m_stats.estimate);
+    size_t inlineCapacity = std::string ().capacity ();
     while (true)
     {
+        size_t capacity = tokenVector.capacity ();
 		tokenVector.push_back(getToken());
+        m_stats.reallocations += tokenVector.capacity () != capacity;
+        m_stats.lexemeAllocations += tokenVector.back ().lexeme.size () > inlineCapacity;
         if (tokenVector.back().type == END_OF_FILE)
 	    {
+            m_stats.tokens = tokenVector.size ();
             return tokenVector;
 	    }
     }
 }
 
+void
+Lexer::tokenize (TokenQueue& queue)
+{
+    std::vector<Token> chunk;
+    chunk.reserve (TokenQueue::CHUNK_TOKENS);
+    while (true)
+    {
+        chunk.push_back (getToken ());
+        if (chunk.back ().type == END_OF_FILE)
+        {
+            queue.push (std::move (chunk));
+            return;
+        }
+        if (chunk.size () == TokenQueue::CHUNK_TOKENS)
+        {
+            queue.push (std::move (chunk));
+            chunk = std::vector<Token> ();
+            chunk.reserve (TokenQueue::CHUNK_TOKENS);
+        }
+    }
+}
+
+const LexStats&
+Lexer::stats () const
+{
+    return m_stats;
+}
+
+size_t
+Lexer::estimateTokens (const char* begin, size_t size)
+{
+    size_t tokens = 1;      // END_OF_FILE
+    const char* p = begin;
+    const char* end = begin + size;
+    while (p < end)
+    {
+        unsigned char c = *p;
+        if (isalpha (c) || isdigit (c))
+        {
+            bool alpha = isalpha (c);
+            while (p < end && (alpha ? isalpha ((unsigned char) *p) : isdigit ((unsigned char) *p)))
+            {
+                ++p;
+            }
+            ++tokens;
+        }
+        else if (c == ' ' || c == '\t' || c == '\n')
+        {
+            ++p;
+        }
+        else if (c == '/' && p + 1 < end && p[1] == '*')
+        {
+            p += 2;
+            while (p < end && !(*p == '*' && p + 1 < end && p[1] == '/'))
+            {
+                ++p;
+            }
+            p = p < end ? p + 2 : end;
+        }
+        else
+        {
+            ++tokens;
+            p += (c == '<' || c == '>' || c == '=' || c == '!') && p + 1 < end && p[1] == '=' ? 2 : 1;
+        }
+    }
+    return tokens;
+}
+
+// Switches a file source to lexing from memory. A regular file is read
+// into a buffer sized from its length, in one allocation.
+void
+Lexer::load ()
+{
+    if (m_srcFile == NULL)
+    {
+        return;
+    }
+    struct stat info;
+    long position = ftell (m_srcFile);
+    if (fstat (fileno (m_srcFile), &info) == 0 && S_ISREG (info.st_mode) && position >= 0 &&
+        info.st_size > position)
+    {
+        m_buffer.reserve (info.st_size - position);
+    }
+    char chunk[1 << 16];
+    size_t n;
+    while ((n = fread (chunk, 1, sizeof (chunk), m_srcFile)) > 0)
+    {
+        m_buffer.append (chunk, n);
+    }
+    fclose (m_srcFile);
+    m_srcFile = NULL;
+    m_cursor = m_buffer.data ();
+    m_end = m_cursor + m_buffer.size ();
+}
+
 Token
 Lexer::lexId ()
 {
     std::string id;
-    char c = getChar ();
+    int c = getChar ();
     while (isalpha (c))
     {
         id.push_back (c);
@@ -117,7 +273,7 @@ Lexer::lexId ()
     }
     else
     {
-        return Token (ID, id, 0, m_lineNum, m_columnNum);
+        return Token (ID, std::move (id), 0, m_lineNum, m_columnNum);
     }
 }
 
@@ -125,24 +281,92 @@ Token
 Lexer::lexNum ()
 {
     std::string strNum;
-    char c = getChar ();
+    int c = getChar ();
     while (isdigit (c))
     {
         strNum.push_back (c);
         c = getChar ();
     }
     ungetChar (c);
-    int intNum = stoi (strNum);
-    return Token (NUM, strNum, intNum, m_lineNum, m_columnNum);
+    // A number too large for an int is an ERROR rather than an exception
+    errno = 0;
+    long intNum = strtol (strNum.c_str (), NULL, 10);
+    if (errno == ERANGE || intNum > INT_MAX)
+    {
+        return Token (ERROR, std::move (strNum), 0, m_lineNum, m_columnNum);
+    }
+    return Token (NUM, std::move (strNum), intNum, m_lineNum, m_columnNum);
     //similar to lexId but change the string to int
 }
 
+// Consumes a comment body through the closing "*/". Returns false if
+// the input ends first, in which case m_inComment stays set.
+bool
+Lexer::skipComment ()
+{
+    m_inComment = true;
+    while (true)
+    {
+        int c = getChar ();
+        if (c == EOF)
+        {
+            return false;
+        }
+        if (c == '\n')
+        {
+            ++m_lineNum;
+            m_columnNum = 0; // why 0?
+        }
+        else if (c == '*')
+        {
+            c = getChar ();
+            if (c == '/')
+            {
+                break;
+            }
+            // "**/" and "*\n" still need a look at the second character
+            ungetChar (c);
+        }
+    }
+    m_inComment = false;
+    return true;
+}
+
+void
+Lexer::setStart (int lineNum, int columnNum, int offset)
+{
+    m_lineNum = lineNum;
+    m_columnNum = columnNum;
+    m_offset = offset;
+}
+
+bool
+Lexer::inComment ()
+{
+    return m_inComment;
+}
+
 Token
 Lexer::getToken ()
 {
+    Token token = scanToken ();
+    token.offset = m_tokenStart;
+    return token;
+}
+
+Token
+Lexer::scanToken ()
+{
+    if (m_inComment && !skipComment ())
+    {
+        m_tokenStart = m_offset;
+        return Token (END_OF_FILE);
+    }
     while (true)
     {
-        char c = getChar ();
+        m_tokenStart = m_offset;
+        // An int, so a 0xFF byte is a stray character rather than EOF
+        int c = getChar ();
         if (isalpha (c))
         {
             ungetChar (c);
@@ -185,22 +409,9 @@ Lexer::getToken ()
                 c = getChar();
                 if (c == '*')
                 {
-                    while (true)
+                    if (!skipComment ())
                     {
-                        c = getChar ();
-                        if (c == '\n')
-                        {
-                            ++m_lineNum;
-                            m_columnNum = 0; // why 0?
-                        }
-                        else if (c == '*')
-                        {
-                            c = getChar ();
-                            if (c == '/')
-                            {
-                                break;
-                            }
-                        }
+                        return Token (END_OF_FILE);
                     }
                 }
                 else
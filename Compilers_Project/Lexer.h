@@ -12,7 +12,9 @@
 
 /***********************/
 
+#include <cstdio>
 #include <string>
+#include <utility>
 #include <vector>
 
 /***********************/
@@ -41,8 +43,9 @@ struct Token
 {
     Token (TokenType pType = END_OF_FILE,
             std::string pLexeme = "",
-            int pNumber = 0, int lineNo = 1, int columnNo = 1)
-        : type (pType), lexeme (pLexeme), number (pNumber), line (lineNo), column (columnNo)
+            int pNumber = 0, int lineNo = 1, int columnNo = 1, int pOffset = 0)
+        : type (pType), lexeme (std::move (pLexeme)), number (pNumber), line (lineNo), column (columnNo),
+          offset (pOffset)
     { }
 
     TokenType   type;
@@ -50,19 +53,66 @@ struct Token
     int         number;
     int         line;
     int         column;
+    int         offset;     // byte offset of the first character
 };
 
 /***********************/
 
-class Lexer
+class TokenQueue;
+
+/***********************/
+
+// What Lexer::tokenize () allocated. The token vector is reserved once
+// for the estimate; reallocations stay 0 unless the estimate was short.
+// Lexemes longer than std::string's inline buffer allocate their own
+// storage, so a source with long identifiers makes more than one
+// allocation per lex.
+struct LexStats
+{
+    size_t bytes;               // source bytes lexed
+    size_t estimate;            // tokens reserved for
+    size_t tokens;
+    size_t reallocations;
+    size_t lexemeAllocations;   // lexemes stored outside the Token
+};
+
+/***********************/
+
+// A lexer engine: the hand-written Lexer below or the flex-generated
+// FlexScanner. Both produce the same tokens, positions included.
+class TokenSource
+{
+public:
+    virtual ~TokenSource () { }
+
+    virtual Token
+    getToken () = 0;
+
+    // Every token through END_OF_FILE
+    virtual std::vector<Token>
+    tokenize () = 0;
+
+    // Streams the tokens to a parser on another thread
+    virtual void
+    tokenize (TokenQueue& queue) = 0;
+};
+
+/***********************/
+
+// final, so its own calls to getToken are not virtual
+class Lexer final : public TokenSource
 {
 public:
     Lexer (FILE* srcFile);
 
+    // Lexes size bytes already in memory. The bytes may start partway
+    // through a source, at the beginning of a line inside a comment.
+    Lexer (const char* begin, size_t size, bool inComment = false);
+
     ~Lexer ();
 
     Token
-    getToken ();
+    getToken () override;
 
     int
     getLineNum ();
@@ -70,14 +120,39 @@ public:
     int
     getColumnNum ();
 
+    // Positions a lexer that starts partway through a source, so its
+    // tokens carry the source's line, column and offset
+    void
+    setStart (int lineNum, int columnNum, int offset);
+
+    // True if the input ended inside an unterminated comment
+    bool
+    inComment ();
+
     Token
     lexId();
 
     Token
     lexNum();
 
+    // Reads the rest of a file source into memory first, so the tokens
+    // can be counted before any is stored
     std::vector<Token>
-    tokenize();
+    tokenize() override;
+
+    void
+    tokenize (TokenQueue& queue) override;
+
+    // Of the last tokenize ()
+    const LexStats&
+    stats () const;
+
+    // An upper bound on the tokens in size bytes of source, from one pass
+    // over their character classes: a run of letters or of digits, or
+    // an operator or other character outside whitespace and comments,
+    // each start at most one token
+    static size_t
+    estimateTokens (const char* begin, size_t size);
 
 private:
     int
@@ -86,10 +161,26 @@ private:
     void
     ungetChar (int c);
 
+    bool
+    skipComment ();
+
+    Token
+    scanToken ();
+
+    void
+    load ();
+
 private:
-    FILE* m_srcFile;
+    FILE* m_srcFile;        // NULL when lexing from memory
+    const char* m_cursor;
+    const char* m_end;
     int m_lineNum;
     int m_columnNum;
+    int m_offset;
+    int m_tokenStart;
+    bool m_inComment;
+    std::string m_buffer;   // a file source, once tokenize () has read it
+    LexStats m_stats;
 };
 
 /***********************/
@@ -0,0 +1,170 @@
+/*
+    Filename    : ParallelLexer.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parallel Lexing
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "ParallelLexer.h"
+
+/***********************/
+
+// Below this a file is lexed on the calling thread only
+static const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+struct Chunk
+{
+    const char* begin;
+    size_t size;
+
+    // Lexer state at the start of the chunk the tokens were produced for
+    bool startsInComment;
+
+    std::vector<Token> tokens;   // without the trailing END_OF_FILE
+    bool endsInComment;
+    int endOffset;               // chunk offset of the END_OF_FILE
+    int newlines;
+};
+
+/***********************/
+
+static std::string
+readAll (FILE* srcFile)
+{
+    std::string text;
+    char buffer[1 << 16];
+    size_t n;
+    while ((n = fread (buffer, 1, sizeof (buffer), srcFile)) > 0)
+    {
+        text.append (buffer, n);
+    }
+    fclose (srcFile);
+    return text;
+}
+
+static void
+lexChunk (Chunk& chunk, bool startsInComment)
+{
+    chunk.startsInComment = startsInComment;
+    chunk.tokens.clear ();
+    chunk.tokens.reserve (Lexer::estimateTokens (chunk.begin, chunk.size));
+    Lexer lex (chunk.begin, chunk.size, startsInComment);
+    while (true)
+    {
+        Token t = lex.getToken ();
+        if (t.type == END_OF_FILE)
+        {
+            chunk.endOffset = t.offset;
+            break;
+        }
+        chunk.tokens.push_back (std::move (t));
+    }
+    chunk.endsInComment = lex.inComment ();
+}
+
+std::vector<Token>
+parallelTokenize (FILE* srcFile, unsigned threads)
+{
+    std::string text = readAll (srcFile);
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+    size_t chunkCount = std::min<size_t> (threads, text.size () / MIN_CHUNK_BYTES + 1);
+
+    // Split just after a newline so no token and no line straddles chunks
+    std::vector<Chunk> chunks (chunkCount);
+    size_t start = 0;
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        size_t end = text.size ();
+        if (i + 1 < chunkCount)
+        {
+            end = std::max (start, text.size () * (i + 1) / chunkCount);
+            const char* newline = (const char*) memchr (text.data () + end, '\n',
+                                                        text.size () - end);
+            end = newline ? newline - text.data () + 1 : text.size ();
+        }
+        chunks[i].begin = text.data () + start;
+        chunks[i].size = end - start;
+        start = end;
+    }
+
+    // Speculative pass: every chunk assumes it starts outside a comment
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunkCount; ++i)
+    {
+        workers.emplace_back ([&chunks, i] {
+            lexChunk (chunks[i], false);
+            chunks[i].newlines = std::count (chunks[i].begin,
+                                             chunks[i].begin + chunks[i].size, '\n');
+        });
+    }
+    lexChunk (chunks[0], false);
+    chunks[0].newlines = std::count (chunks[0].begin, chunks[0].begin + chunks[0].size, '\n');
+    for (std::thread& worker : workers)
+    {
+        worker.join ();
+    }
+
+    // Walk the real comment state forward, re-lexing wrong guesses
+    bool inComment = false;
+    std::vector<size_t> offsets (chunkCount + 1, 0);
+    std::vector<int> firstLines (chunkCount, 1);
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        Chunk& chunk = chunks[i];
+        if (chunk.startsInComment != inComment)
+        {
+            lexChunk (chunk, inComment);
+        }
+        inComment = chunk.endsInComment;
+        offsets[i + 1] = offsets[i] + chunk.tokens.size ();
+        if (i + 1 < chunkCount)
+        {
+            firstLines[i + 1] = firstLines[i] + chunk.newlines;
+        }
+    }
+
+    // Stitch, shifting each chunk's lines and offsets by what precedes it
+    std::vector<Token> tokens (offsets[chunkCount] + 1);
+    const char* base = text.data ();
+    auto stitch = [&chunks, &tokens, &offsets, &firstLines, base] (size_t i) {
+        int lineShift = firstLines[i] - 1;
+        int offsetShift = chunks[i].begin - base;
+        Token* out = tokens.data () + offsets[i];
+        for (Token& t : chunks[i].tokens)
+        {
+            t.line += lineShift;
+            t.offset += offsetShift;
+            *out++ = std::move (t);
+        }
+    };
+    workers.clear ();
+    for (size_t i = 1; i < chunkCount; ++i)
+    {
+        workers.emplace_back (stitch, i);
+    }
+    stitch (0);
+    for (std::thread& worker : workers)
+    {
+        worker.join ();
+    }
+    // The sequential lexer's END_OF_FILE sits where it stopped reading
+    const Chunk& last = chunks[chunkCount - 1];
+    tokens.back () = Token (END_OF_FILE);
+    tokens.back ().offset = last.endOffset + (last.begin - base);
+    return tokens;
+}
@@ -0,0 +1,32 @@
+/*
+    Filename    : ParallelLexer.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parallel Lexing
+*/
+
+/***********************/
+
+#ifndef PARALLEL_LEXER_H
+#define PARALLEL_LEXER_H
+
+/***********************/
+
+#include <cstdio>
+#include <vector>
+
+#include "Lexer.h"
+
+/***********************/
+
+// Reads all of srcFile, splits it at newlines into one chunk per thread
+// and lexes the chunks concurrently. Each chunk is first lexed assuming
+// it starts outside a comment; chunks that actually begin inside a
+// "/* */" comment are re-lexed once the state at their start is known.
+// The result is identical to Lexer (srcFile).tokenize (). Closes srcFile.
+std::vector<Token>
+parallelTokenize (FILE* srcFile, unsigned threads);
+
+/***********************/
+
+#endif
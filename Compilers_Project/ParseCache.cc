@@ -0,0 +1,294 @@
+/*
+    Filename    : ParseCache.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parse Cache
+*/
+
+/***********************/
+// System includes
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/***********************/
+// Local includes
+
+#include "ParseCache.h"
+
+/***********************/
+
+static const char MAGIC[8] = { 'C', 'M', 'C', 'A', 'C', 'H', 'E', '\0' };
+static const uint32_t VERSION = 2;
+
+// Bumped whenever the same source can lex or parse differently: other
+// tokens, or another diagnostic. Entries from another compiler are not
+// just rejected but never found, since it seeds the key.
+//   1  first cached release
+//   2  numbers too large for an int are ERROR tokens; rule names in
+//      diagnostics come from Parser.h; 0xFF is an ERROR token
+static const uint32_t COMPILER = 2;
+
+struct Header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t tokenCount;
+    uint64_t hash;
+    uint64_t sourceSize;
+    uint32_t diagnosticBytes;
+    uint32_t compiler;
+};
+
+struct TokenRecord
+{
+    uint32_t type;
+    int32_t  line;
+    int32_t  column;
+    int32_t  offset;
+    int32_t  number;
+    uint32_t length;        // lexeme is source[offset, offset + length)
+};
+
+/***********************/
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t
+rotl (uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+read64 (const char* p)
+{
+    uint64_t v;
+    memcpy (&v, p, sizeof (v));
+    return v;
+}
+
+static inline uint32_t
+read32 (const char* p)
+{
+    uint32_t v;
+    memcpy (&v, p, sizeof (v));
+    return v;
+}
+
+static inline uint64_t
+mix (uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME2;
+    return rotl (acc, 31) * PRIME1;
+}
+
+static inline uint64_t
+mergeRound (uint64_t acc, uint64_t val)
+{
+    acc ^= mix (0, val);
+    return acc * PRIME1 + PRIME4;
+}
+
+/***********************/
+
+ParseCache::ParseCache (const std::string& directory)
+    : m_directory (directory), m_map (NULL), m_mapSize (0)
+{
+}
+
+ParseCache::~ParseCache ()
+{
+    unmap ();
+}
+
+uint64_t
+ParseCache::hash (const char* data, size_t size, uint64_t seed)
+{
+    const char* p = data;
+    const char* end = data + size;
+    uint64_t h;
+
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        do
+        {
+            v1 = mix (v1, read64 (p));
+            v2 = mix (v2, read64 (p + 8));
+            v3 = mix (v3, read64 (p + 16));
+            v4 = mix (v4, read64 (p + 24));
+            p += 32;
+        } while (p + 32 <= end);
+        h = rotl (v1, 1) + rotl (v2, 7) + rotl (v3, 12) + rotl (v4, 18);
+        h = mergeRound (h, v1);
+        h = mergeRound (h, v2);
+        h = mergeRound (h, v3);
+        h = mergeRound (h, v4);
+    }
+    else
+    {
+        h = seed + PRIME5;
+    }
+    h += size;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        h ^= mix (0, read64 (p));
+        h = rotl (h, 27) * PRIME1 + PRIME4;
+    }
+    if (p + 4 <= end)
+    {
+        h ^= read32 (p) * PRIME1;
+        h = rotl (h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+    {
+        h ^= (unsigned char) *p * PRIME5;
+        h = rotl (h, 11) * PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool
+ParseCache::lookup (const char* source, size_t size)
+{
+    unmap ();
+    uint64_t key = hash (source, size, COMPILER);
+    int fd = open (entryPath (key).c_str (), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat (fd, &info) != 0 || (size_t) info.st_size < sizeof (Header))
+    {
+        close (fd);
+        return false;
+    }
+    void* map = mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+    m_map = (const char*) map;
+    m_mapSize = info.st_size;
+
+    const Header* header = (const Header*) m_map;
+    if (memcmp (header->magic, MAGIC, sizeof (MAGIC)) != 0 || header->version != VERSION ||
+        header->compiler != COMPILER || header->hash != key || header->sourceSize != size ||
+        m_mapSize != sizeof (Header) + header->tokenCount * sizeof (TokenRecord) +
+                     header->diagnosticBytes)
+    {
+        unmap ();
+        return false;
+    }
+    return true;
+}
+
+bool
+ParseCache::valid ()
+{
+    return ((const Header*) m_map)->diagnosticBytes == 0;
+}
+
+std::string
+ParseCache::diagnostic ()
+{
+    const Header* header = (const Header*) m_map;
+    return std::string (m_map + m_mapSize - header->diagnosticBytes, header->diagnosticBytes);
+}
+
+std::vector<Token>
+ParseCache::tokens (const char* source)
+{
+    const Header* header = (const Header*) m_map;
+    const TokenRecord* records = (const TokenRecord*) (m_map + sizeof (Header));
+
+    std::vector<Token> tokens;
+    tokens.reserve (header->tokenCount);
+    for (uint32_t i = 0; i < header->tokenCount; ++i)
+    {
+        const TokenRecord& r = records[i];
+        tokens.push_back (Token ((TokenType) r.type,
+                                 std::string (source + r.offset, r.length),
+                                 r.number, r.line, r.column, r.offset));
+    }
+    return tokens;
+}
+
+void
+ParseCache::store (const char* source, size_t size, const std::vector<Token>& tokens,
+                   const std::string& diagnostic)
+{
+    Header header;
+    memcpy (header.magic, MAGIC, sizeof (MAGIC));
+    header.version = VERSION;
+    header.tokenCount = tokens.size ();
+    header.hash = hash (source, size, COMPILER);
+    header.sourceSize = size;
+    header.diagnosticBytes = diagnostic.size ();
+    header.compiler = COMPILER;
+
+    std::vector<TokenRecord> records (tokens.size ());
+    for (size_t i = 0; i < tokens.size (); ++i)
+    {
+        const Token& t = tokens[i];
+        records[i] = { (uint32_t) t.type, t.line, t.column, t.offset, t.number,
+                       (uint32_t) t.lexeme.size () };
+    }
+
+    mkdir (m_directory.c_str (), 0777);
+    std::string path = entryPath (header.hash);
+    std::string temp = path + "." + std::to_string (getpid ());
+    FILE* out = fopen (temp.c_str (), "wb");
+    if (out == NULL)
+    {
+        return;
+    }
+    bool written = fwrite (&header, sizeof (header), 1, out) == 1 &&
+                   fwrite (records.data (), sizeof (TokenRecord), records.size (), out) == records.size () &&
+                   fwrite (diagnostic.data (), 1, diagnostic.size (), out) == diagnostic.size ();
+    if (fclose (out) != 0 || !written || rename (temp.c_str (), path.c_str ()) != 0)
+    {
+        remove (temp.c_str ());
+    }
+}
+
+std::string
+ParseCache::entryPath (uint64_t key)
+{
+    char name[32];
+    snprintf (name, sizeof (name), "/%016llx.cmc", (unsigned long long) key);
+    return m_directory + name;
+}
+
+void
+ParseCache::unmap ()
+{
+    if (m_map != NULL)
+    {
+        munmap ((void*) m_map, m_mapSize);
+        m_map = NULL;
+        m_mapSize = 0;
+    }
+}
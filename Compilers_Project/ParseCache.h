@@ -0,0 +1,89 @@
+/*
+    Filename    : ParseCache.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parse Cache
+*/
+
+/***********************/
+
+#ifndef PARSE_CACHE_H
+#define PARSE_CACHE_H
+
+/***********************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Lexer.h"
+
+/***********************/
+
+// On-disk cache of lex/parse results keyed by a 64-bit hash of the
+// source bytes, seeded with a compiler version, so a file that has not
+// changed (or was only touched) is never lexed or parsed again by the
+// same compiler. Each entry is one file, <hash>.cmc, laid
+// out so it can be used straight from an mmap:
+//
+//   Header          fixed size, see ParseCache.cc
+//   TokenRecord[n]  type, line, column, offset, number, lexeme length
+//   diagnostic      what CMinus prints for an invalid program, "" if valid
+//
+// Every lexeme is the source bytes at its token's offset, so lexemes are
+// not stored. All fields are 32- or 64-bit little-endian integers, and a
+// hit only touches the header and diagnostic pages. The header stores
+// the full hash and source size, which are checked on lookup, a format
+// version and the compiler version; entries from another version of
+// either are treated as misses.
+class ParseCache
+{
+public:
+    // The directory is created on first store if it does not exist
+    ParseCache (const std::string& directory);
+
+    ~ParseCache ();
+
+    // xxHash64 of size bytes
+    static uint64_t
+    hash (const char* data, size_t size, uint64_t seed = 0);
+
+    // Maps the entry for the source; false if there is none
+    bool
+    lookup (const char* source, size_t size);
+
+    // Results of the last successful lookup
+    bool
+    valid ();
+
+    std::string
+    diagnostic ();
+
+    // Rebuilds the token stream; source must be the bytes looked up
+    std::vector<Token>
+    tokens (const char* source);
+
+    // Writes the entry for the source. Entries are written to a temporary
+    // file and renamed into place, so concurrent builds never see half of
+    // one. Failing to write is not an error; the cache just misses.
+    void
+    store (const char* source, size_t size, const std::vector<Token>& tokens,
+           const std::string& diagnostic);
+
+private:
+    std::string
+    entryPath (uint64_t key);
+
+    void
+    unmap ();
+
+private:
+    std::string m_directory;
+    const char* m_map;
+    size_t m_mapSize;
+};
+
+/***********************/
+
+#endif
@@ -6,13 +6,113 @@
 */
 
 
+#include <algorithm>
+#include <climits>
+#include <exception>
+#include <pthread.h>
+#include <utility>
+
+#include "Ast.h"
 #include "Parser.h"
 #include "Lexer.h"
+#include "TokenQueue.h"
+
+// An instrumented build (-DPARSER_PROFILE) counts calls, matched tokens
+// and rewinds per grammar function; see ParserProfile.h
+#ifdef PARSER_PROFILE
+#include "ParserProfile.h"
+#define PROFILE_RULE(rule) ParserProfiler::Scope profileScope (rule)
+#define PROFILE_MATCH() g_parserProfiler.tokenMatched ()
+#define PROFILE_REWIND(tokens) g_parserProfiler.rewind (tokens)
+#else
+#define PROFILE_RULE(rule)
+#define PROFILE_MATCH()
+#define PROFILE_REWIND(tokens)
+#endif
+
+// Tree building, only done under parse ()
+#define BUILD(step)             \
+    if (m_ast != NULL)          \
+    {                           \
+        m_ast->step;            \
+    }
+
+#define BUILD_MARK(name) \
+    Ast::Mark name = m_ast != NULL ? m_ast->mark () : Ast::Mark ()
+
+// Every recursive cycle in the grammar goes through stmt or expr. Those
+// two count their nesting, and once a stack segment has taken its share
+// of levels the parse continues on a freshly allocated stack, so nesting
+// is bounded by memory rather than by the size of the C++ stack. The
+// first segment is the caller's own stack, so it is kept small enough
+// for any default ulimit; ordinary programs never leave it.
+static const int FIRST_SEGMENT_DEPTH = 1000;
+static const int SEGMENT_DEPTH = 20000;
+static const size_t SEGMENT_STACK_BYTES = 64 * 1024 * 1024;
+
+#define CHECK_DEPTH(rule)               \
+    if (m_depth >= m_depthLimit)        \
+    {                                   \
+        spill (&Parser::rule);          \
+        return;                         \
+    }                                   \
+    DepthGuard depthGuard (m_depth)
+
+namespace
+{
+    struct DepthGuard
+    {
+        DepthGuard (int& depth) : m_depth (depth) { ++m_depth; }
+        ~DepthGuard () { --m_depth; }
+        int& m_depth;
+    };
+
+    struct Continuation
+    {
+        Parser* parser;
+        void (Parser::*rule) ();
+        std::exception_ptr error;
+    };
+
+    void*
+    runContinuation (void* arg)
+    {
+        Continuation* k = (Continuation*) arg;
+        try
+        {
+            (k->parser->*k->rule) ();
+        }
+        catch (...)
+        {
+            k->error = std::current_exception ();
+        }
+        return NULL;
+    }
+}
+
+// Lookahead used by the grammar functions beyond m_tokens[m_index]
+static const int LOOKAHEAD = 2;
 
 Parser::Parser (std::vector<Token> tokenVector)
 {
-    m_tokens = tokenVector;
+    m_tokens = std::move (tokenVector);
+    m_index = 0;
+    m_depth = 0;
+    m_depthLimit = FIRST_SEGMENT_DEPTH;
+    m_queue = NULL;
+    m_fillMark = INT_MAX;
+    m_ast = NULL;
+}
+
+Parser::Parser (TokenQueue& queue)
+{
     m_index = 0;
+    m_depth = 0;
+    m_depthLimit = FIRST_SEGMENT_DEPTH;
+    m_queue = &queue;
+    m_fillMark = 0;
+    m_ast = NULL;
+    fill ();
 }
 
 Parser::~Parser ()
@@ -21,56 +121,183 @@ Parser::~Parser ()
 }
 
 void
-Parser::match (const std::string& function, TokenType expectedType)
+Parser::match (ParserRule rule, TokenType expectedType)
 {
     if (m_tokens[m_index].type == expectedType)
     {
+        PROFILE_MATCH ();
         m_index++;
+        if (m_index >= m_fillMark)
+        {
+            fill ();
+        }
     }
     else
     {
-        error (function, expectedType);
+        error (rule, expectedType);
     }
 
 }
 
 void
-Parser::error (const std::string& function, TokenType expectedType)
+Parser::error (ParserRule rule, TokenType expectedType)
 {
-    printf ("\n Error while parsing: \'%s\'\n", function.c_str ());
-    printf ("\tEncountered: %s (line %d, column %d)\n", m_tokens[m_index].lexeme.c_str(), m_tokens[m_index].line, m_tokens[m_index].column);
-    printf ("\t Expected :%u\n", expectedType);
-    exit (1);
+    throw ParseError (RULE_NAMES[rule], expectedType, m_index);
+}
+
+std::string
+Parser::describe (const ParseError& e)
+{
+    return ::describe (m_tokens, e);
+}
+
+std::string
+describe (const std::vector<Token>& tokens, const ParseError& e)
+{
+    const Token& t = tokens[e.index];
+    char buffer[128];
+    std::string message = "\n Error while parsing: ";
+    if (e.expected == ERROR)
+    {
+        message += e.function;
+        message += "\n";
+    }
+    else
+    {
+        message += "\'";
+        message += e.function;
+        message += "\'\n";
+    }
+    message += "\tEncountered: " + t.lexeme;
+    snprintf (buffer, sizeof (buffer), " (line %d, column %d)\n", t.line, t.column);
+    message += buffer;
+    if (e.expected != ERROR)
+    {
+        snprintf (buffer, sizeof (buffer), "\t Expected :%u\n", e.expected);
+        message += buffer;
+    }
+    return message;
 }
 
 void
-Parser::start()
+Parser::fill ()
+{
+    while (m_fillMark != INT_MAX && m_index >= m_fillMark)
+    {
+        std::vector<Token> chunk = m_queue->pop ();
+        bool last = chunk.back ().type == END_OF_FILE;
+        m_tokens.insert (m_tokens.end (), std::make_move_iterator (chunk.begin ()),
+                         std::make_move_iterator (chunk.end ()));
+        m_fillMark = last ? INT_MAX : (int) m_tokens.size () - LOOKAHEAD;
+    }
+}
+
+// Type of the token k past m_index; END_OF_FILE past the end of input
+TokenType
+Parser::lookahead (int k)
+{
+    size_t i = std::min (m_index + k, (int) m_tokens.size () - 1);
+    return m_tokens[i].type;
+}
+
+// Runs rule on a new stack segment and waits for it, so the parse stays
+// sequential. Without a thread for the segment the input is too deep to
+// parse; that is a ParseError, so a server reports it and carries on.
+void
+Parser::spill (void (Parser::*rule) ())
+{
+    int savedLimit = m_depthLimit;
+    m_depthLimit = m_depth + SEGMENT_DEPTH;
+
+    Continuation k = { this, rule };
+    pthread_attr_t attr;
+    pthread_attr_init (&attr);
+    pthread_attr_setstacksize (&attr, SEGMENT_STACK_BYTES);
+    pthread_t segment;
+    int failed = pthread_create (&segment, &attr, runContinuation, &k);
+    pthread_attr_destroy (&attr);
+    if (failed != 0)
+    {
+        m_depthLimit = savedLimit;
+        throw ParseError ("nesting too deep", ERROR, m_index);
+    }
+    pthread_join (segment, NULL);
+
+    m_depthLimit = savedLimit;
+    if (k.error)
+    {
+        std::rethrow_exception (k.error);
+    }
+}
+
+std::string
+Parser::check ()
+{
+    try
+    {
+        program();
+        if (m_tokens[m_index].type != END_OF_FILE)
+        {
+            error (RULE_PROGRAM, END_OF_FILE);
+        }
+    }
+    catch (const ParseError& e)
+    {
+        return describe (e);
+    }
+    return "";
+}
+
+std::string
+Parser::parse (Ast& ast)
 {
-    program();
-    if (m_tokens[m_index].type != END_OF_FILE)
+    ast.clear ();
+    m_ast = &ast;
+    std::string message = check ();
+    m_ast = NULL;
+    if (message.empty ())
     {
-        error("program", END_OF_FILE);
+        ast.finish ();
     }
     else
     {
-        printf("Valid!\n");
+        ast.clear ();
+    }
+    return message;
+}
+
+// Parses the whole token stream, printing "Valid!" or the first error.
+// An invalid program exits with status 1.
+void
+Parser::start()
+{
+    std::string message = check ();
+    if (!message.empty ())
+    {
+        printf ("%s", message.c_str ());
+        exit (1);
     }
+    printf("Valid!\n");
 }
 //program -> declarationList
 void
 Parser::program ()
 {
+    PROFILE_RULE (RULE_PROGRAM);
     if (m_tokens[m_index].type == END_OF_FILE)
     {
-        error("program", INT);
+        error (RULE_PROGRAM, INT);
     }
+    BUILD_MARK (mark);
     declarationList ();
+    BUILD (reduce (AST_PROGRAM, 0, 0, m_ast->since (mark)));
 }
 
 //declarationList -> declaration {declaration}
 void
 Parser::declarationList ()
 {
+    PROFILE_RULE (RULE_DECLARATION_LIST);
     declaration ();
     while (m_tokens[m_index].type != END_OF_FILE)
     {
@@ -83,17 +310,14 @@ Parser::declarationList ()
 void
 Parser::declaration ()
 {
-    if (m_tokens[m_index + 2].type == LPAREN)
+    PROFILE_RULE (RULE_DECLARATION);
+    if (lookahead (2) == LPAREN)
     {
         funDeclaration ();
     }
-    else if (m_tokens[m_index + 2].type == LBRACK)
-    {
-        varDeclaration ();
-    }
     else
     {
-        //error ();
+        varDeclaration ();
     }
 
 }
@@ -102,29 +326,39 @@ Parser::declaration ()
 void
 Parser::varDeclaration ()
 {
+    PROFILE_RULE (RULE_VAR_DECLARATION);
+    TokenType type = m_tokens[m_index].type;
     typeSpecifier ();
-    match ("varDeclaration", ID);
+    int id = m_index;
+    match (RULE_VAR_DECLARATION, ID);
 
     if (m_tokens[m_index].type == LBRACK)
     {
-        match ("varDeclaration", LBRACK);
-        match ("varDeclaration", NUM);
-        match ("varDeclaration", RBRACK);
+        match (RULE_VAR_DECLARATION, LBRACK);
+        int length = m_tokens[m_index].number;
+        match (RULE_VAR_DECLARATION, NUM);
+        match (RULE_VAR_DECLARATION, RBRACK);
+        BUILD (leaf (AST_ARRAY_DECL, type, id, length));
+    }
+    else
+    {
+        BUILD (leaf (AST_VAR_DECL, type, id));
     }
-    match ("varDeclaration", SEMI);
+    match (RULE_VAR_DECLARATION, SEMI);
 }
 
 //typeSpecifier -> 'INT' | 'VOID'
 void 
 Parser::typeSpecifier ()
 {
+    PROFILE_RULE (RULE_TYPE_SPECIFIER);
     if (m_tokens[m_index].type == INT)
     {
-        match ("typeSpecifier", INT);
+        match (RULE_TYPE_SPECIFIER, INT);
     }
     else if (m_tokens[m_index].type == VOID)
     {
-        match ("typeSpecifier", VOID);
+        match (RULE_TYPE_SPECIFIER, VOID);
     }
     else
     {
@@ -137,12 +371,17 @@ Parser::typeSpecifier ()
 void
 Parser::funDeclaration ()
 {
+    PROFILE_RULE (RULE_FUN_DECLARATION);
+    BUILD_MARK (mark);
+    TokenType type = m_tokens[m_index].type;
     typeSpecifier ();
-    match ("funDeclaration", ID);
-    match ("funDeclaration", LPAREN);
+    int id = m_index;
+    match (RULE_FUN_DECLARATION, ID);
+    match (RULE_FUN_DECLARATION, LPAREN);
     params ();
-    match ("funDeclaration", RPAREN);
+    match (RULE_FUN_DECLARATION, RPAREN);
     compoundStmt ();
+    BUILD (reduce (AST_FUN_DECL, type, id, m_ast->since (mark)));
 
 }
 
@@ -150,13 +389,14 @@ Parser::funDeclaration ()
 void
 Parser::params ()
 {
+    PROFILE_RULE (RULE_PARAMS);
     if ((m_tokens[m_index].type == INT) && (m_tokens[m_index + 1].type == ID))
     {
         paramList ();
     }
     else if (m_tokens[m_index].type == VOID)
     {
-        match ("params", VOID);
+        match (RULE_PARAMS, VOID);
     }
     else
     {
@@ -168,10 +408,11 @@ Parser::params ()
 void
 Parser::paramList ()
 {
+    PROFILE_RULE (RULE_PARAM_LIST);
     param ();
     while (m_tokens[m_index].type == COMMA)
     {
-        match ("paramList", COMMA);
+        match (RULE_PARAM_LIST, COMMA);
         param ();
     }
 }
@@ -180,12 +421,20 @@ Parser::paramList ()
 void
 Parser::param()
 {
+    PROFILE_RULE (RULE_PARAM);
+    TokenType type = m_tokens[m_index].type;
     typeSpecifier();
-    match("param", ID);
+    int id = m_index;
+    match (RULE_PARAM, ID);
     if(m_tokens[m_index].type == LBRACK)
     {
-        match("param", LBRACK);
-        match("param", RBRACK);
+        match (RULE_PARAM, LBRACK);
+        match (RULE_PARAM, RBRACK);
+        BUILD (leaf (AST_ARRAY_PARAM, type, id));
+    }
+    else
+    {
+        BUILD (leaf (AST_PARAM, type, id));
     }
 
 }
@@ -194,10 +443,14 @@ Parser::param()
 void
 Parser::compoundStmt ()
 {
-    match("compoundStmt", LBRACE);
+    PROFILE_RULE (RULE_COMPOUND_STMT);
+    BUILD_MARK (mark);
+    int brace = m_index;
+    match (RULE_COMPOUND_STMT, LBRACE);
     localDeclarations();
     stmtList();
-    match("compountStmt", RBRACE);
+    match (RULE_COMPOUND_STMT, RBRACE);
+    BUILD (reduce (AST_COMPOUND, 0, brace, m_ast->since (mark)));
 
 }
 
@@ -205,6 +458,7 @@ Parser::compoundStmt ()
 void
 Parser::localDeclarations ()
 {
+    PROFILE_RULE (RULE_LOCAL_DECLARATIONS);
     while((m_tokens[m_index].type == INT) || (m_tokens[m_index].type == VOID))
     {
         varDeclaration ();
@@ -215,6 +469,7 @@ Parser::localDeclarations ()
 void
 Parser::stmtList ()
 {
+    PROFILE_RULE (RULE_STMT_LIST);
     while((m_tokens[m_index].type == ID) || (m_tokens[m_index].type == SEMI) ||
             (m_tokens[m_index].type == LBRACE) || (m_tokens[m_index].type == IF) ||
             (m_tokens[m_index].type == WHILE) || (m_tokens[m_index].type == RETURN))
@@ -227,6 +482,8 @@ Parser::stmtList ()
 void
 Parser::stmt ()
 {
+    PROFILE_RULE (RULE_STMT);
+    CHECK_DEPTH (stmt);
     if ((m_tokens[m_index].type == ID) || (m_tokens[m_index].type == SEMI))
     {
         expressionStmt ();
@@ -249,7 +506,9 @@ Parser::stmt ()
     }
     else
     {
-        //error
+        // Accepted without matching anything, as the grammar always has
+        // been; the leaf keeps 'while' and 'if' at their fixed child counts
+        BUILD (leaf (AST_EMPTY, 0, m_index));
     }
 
 }
@@ -258,11 +517,16 @@ Parser::stmt ()
 void
 Parser::expressionStmt ()
 {
+    PROFILE_RULE (RULE_EXPRESSION_STMT);
+    int first = m_index;
+    int count = 0;
     if ((m_tokens[m_index].type == ID) || (m_tokens[m_index].type == LPAREN) || (m_tokens[m_index].type == NUM))
     {
         expr ();
+        count = 1;
     }
-    match ("expressionStmt", SEMI);
+    match (RULE_EXPRESSION_STMT, SEMI);
+    BUILD (reduce (AST_EXPR_STMT, 0, first, count));
 
 }
 
@@ -270,16 +534,21 @@ Parser::expressionStmt ()
 void
 Parser::selectionStmt ()
 {
-    match ("selectionStmt", IF);
-    match ("selectionStmt", LPAREN);
+    PROFILE_RULE (RULE_SELECTION_STMT);
+    int first = m_index;
+    int count = 2;
+    match (RULE_SELECTION_STMT, IF);
+    match (RULE_SELECTION_STMT, LPAREN);
     expr ();
-    match ("selectionStmt", RPAREN);
+    match (RULE_SELECTION_STMT, RPAREN);
     stmt ();
     if (m_tokens[m_index].type == ELSE)
     {
-        match ("selectionStmt", ELSE);
+        match (RULE_SELECTION_STMT, ELSE);
         stmt ();
+        count = 3;
     }
+    BUILD (reduce (AST_IF, 0, first, count));
 
 }
 
@@ -287,11 +556,14 @@ Parser::selectionStmt ()
 void
 Parser::iterationStmt ()
 {
-    match ("iterationStmt", WHILE);
-    match ("iterationStmt", LPAREN);
+    PROFILE_RULE (RULE_ITERATION_STMT);
+    int first = m_index;
+    match (RULE_ITERATION_STMT, WHILE);
+    match (RULE_ITERATION_STMT, LPAREN);
     expr ();
-    match ("iterationStmt", RPAREN);
+    match (RULE_ITERATION_STMT, RPAREN);
     stmt ();
+    BUILD (reduce (AST_WHILE, 0, first, 2));
 
 }
 
@@ -299,12 +571,17 @@ Parser::iterationStmt ()
 void
 Parser::returnStmt ()
 {
-    match ("returnStmt", RETURN);
+    PROFILE_RULE (RULE_RETURN_STMT);
+    int first = m_index;
+    int count = 0;
+    match (RULE_RETURN_STMT, RETURN);
     if ((m_tokens[m_index].type == ID) || (m_tokens[m_index].type == LPAREN) | (m_tokens[m_index].type == NUM))
     {
         expr ();
+        count = 1;
     }
-    match ("returnStmt", SEMI);
+    match (RULE_RETURN_STMT, SEMI);
+    BUILD (reduce (AST_RETURN, 0, first, count));
 
 }
 
@@ -313,30 +590,53 @@ Parser::returnStmt ()
 void
 Parser::expr ()
 {
+    PROFILE_RULE (RULE_EXPR);
+    CHECK_DEPTH (expr);
+    // '=' tokens of the targets, for building the assignments right to left
+    std::vector<int> assigns;
     while (m_tokens[m_index].type == ID) {
         int saved = m_index;
+        BUILD_MARK (mark);
         var();
         // lookahead said there isn't an assign -- must be simpleExpr
         if (m_tokens[m_index].type != ASSIGN) {
+            PROFILE_REWIND (m_index - saved);
             m_index = saved;
+            BUILD (rewind (mark));
             break;
         }
-        match("expr", ASSIGN);
+        if (m_ast != NULL)
+        {
+            assigns.push_back (m_index);
+        }
+        match (RULE_EXPR, ASSIGN);
     }
     // doesn't start with ID -- must be a simpleExpr
     simpleExpr();
+    while (!assigns.empty ())
+    {
+        m_ast->reduce (AST_ASSIGN, ASSIGN, assigns.back (), 2);
+        assigns.pop_back ();
+    }
 }
 
 //var -> ID [ '[' expr ']' ]
 void
 Parser::var ()
 {
-    match ("var", ID);
+    PROFILE_RULE (RULE_VAR);
+    int id = m_index;
+    match (RULE_VAR, ID);
     if (m_tokens[m_index].type == LBRACK)
     {
-        match ("var", LBRACK);
+        match (RULE_VAR, LBRACK);
         expr ();
-        match ("var", RBRACK);
+        match (RULE_VAR, RBRACK);
+        BUILD (reduce (AST_SUBSCRIPT, 0, id, 1));
+    }
+    else
+    {
+        BUILD (leaf (AST_VAR, 0, id));
     }
 
 }
@@ -345,13 +645,16 @@ Parser::var ()
 void
 Parser::simpleExpr ()
 {
+    PROFILE_RULE (RULE_SIMPLE_EXPR);
     additiveExpr ();
     while ((m_tokens[m_index].type == LT) || (m_tokens[m_index].type == LTE) ||
         (m_tokens[m_index].type == GT) || (m_tokens[m_index].type == GTE) ||
         (m_tokens[m_index].type == EQ) || (m_tokens[m_index].type == NEQ))
     {
+        int op = m_index;
         relop ();
         additiveExpr ();
+        BUILD (reduce (AST_BINARY, m_tokens[op].type, op, 2));
     }
 
 }
@@ -360,6 +663,7 @@ Parser::simpleExpr ()
 void
 Parser::relop ()
 {
+    PROFILE_RULE (RULE_RELOP);
     TokenType t = m_tokens[m_index].type;
     switch (t) {
         case LT:
@@ -368,7 +672,7 @@ Parser::relop ()
         case GTE:
         case EQ:
         case NEQ:
-            match ("additiveExpr", t);
+            match (RULE_ADDITIVE_EXPR, t);
         default:
             ;
     }
@@ -378,11 +682,14 @@ Parser::relop ()
 void
 Parser::additiveExpr ()
 {
+    PROFILE_RULE (RULE_ADDITIVE_EXPR);
     term ();
     while ((m_tokens[m_index].type == PLUS) || (m_tokens[m_index].type == MINUS))
     {
+        int op = m_index;
         addop ();
         term ();
+        BUILD (reduce (AST_BINARY, m_tokens[op].type, op, 2));
     }
 
 }
@@ -391,13 +698,14 @@ Parser::additiveExpr ()
 void
 Parser::addop ()
 {
+    PROFILE_RULE (RULE_ADDOP);
     if (m_tokens[m_index].type == PLUS)
     {
-        match ("addop", PLUS);
+        match (RULE_ADDOP, PLUS);
     }
     else if (m_tokens[m_index].type == MINUS)
     {
-        match ("addop", MINUS);
+        match (RULE_ADDOP, MINUS);
     }
     else 
     {
@@ -410,11 +718,14 @@ Parser::addop ()
 void
 Parser::term ()
 {
+    PROFILE_RULE (RULE_TERM);
     factor ();
     while ((m_tokens[m_index].type == TIMES) || (m_tokens[m_index].type == DIVIDE))
     {
+        int op = m_index;
         mulop ();
         factor ();
+        BUILD (reduce (AST_BINARY, m_tokens[op].type, op, 2));
     }
 
 }
@@ -423,13 +734,14 @@ Parser::term ()
 void
 Parser::mulop ()
 {
+    PROFILE_RULE (RULE_MULOP);
     if (m_tokens[m_index].type == TIMES)
     {
-        match ("mulop", TIMES);
+        match (RULE_MULOP, TIMES);
     }
     else if (m_tokens[m_index].type == DIVIDE)
     {
-        match ("mulop", DIVIDE);
+        match (RULE_MULOP, DIVIDE);
     }
     else
     {
@@ -441,11 +753,12 @@ Parser::mulop ()
 void
 Parser::factor ()
 {
+    PROFILE_RULE (RULE_FACTOR);
     if (m_tokens[m_index].type == LPAREN)
     {
-        match ("factor", LPAREN);
+        match (RULE_FACTOR, LPAREN);
         expr ();
-        match ("factor", RPAREN);
+        match (RULE_FACTOR, RPAREN);
     }
     else if ((m_tokens[m_index].type == ID) && (m_tokens[m_index + 1].type == LPAREN))
     {
@@ -457,7 +770,12 @@ Parser::factor ()
     }
     else if (m_tokens[m_index].type == NUM)
     {
-        match ("factor", NUM);
+        BUILD (leaf (AST_NUM, 0, m_index, m_tokens[m_index].number));
+        match (RULE_FACTOR, NUM);
+    }
+    else
+    {
+        BUILD (leaf (AST_EMPTY, 0, m_index));
     }
 }
 
@@ -465,16 +783,21 @@ Parser::factor ()
 void
 Parser::call ()
 {
-    match ("call", ID);
-    match ("call", LPAREN);
+    PROFILE_RULE (RULE_CALL);
+    BUILD_MARK (mark);
+    int id = m_index;
+    match (RULE_CALL, ID);
+    match (RULE_CALL, LPAREN);
     args ();
-    match ("call", RPAREN);
+    match (RULE_CALL, RPAREN);
+    BUILD (reduce (AST_CALL, 0, id, m_ast->since (mark)));
 }
 
 //args -> [argList]
 void
 Parser::args ()
 {
+    PROFILE_RULE (RULE_ARGS);
     if ((m_tokens[m_index].type == ID) || (m_tokens[m_index].type == LPAREN) | (m_tokens[m_index].type == NUM))
     {
         argList ();
@@ -486,10 +809,11 @@ Parser::args ()
 void
 Parser::argList ()
 {
+    PROFILE_RULE (RULE_ARG_LIST);
     expr ();
     while (m_tokens[m_index].type == COMMA)
     {
-        match ("argList", COMMA);
+        match (RULE_ARG_LIST, COMMA);
         expr ();
     }
 
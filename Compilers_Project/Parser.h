@@ -14,18 +14,84 @@
 #include <vector>
 #include "Lexer.h"
 
+class Ast;
+class TokenQueue;
+
+// One entry per grammar function in Parser
+enum ParserRule
+{
+    RULE_NONE,
+    RULE_PROGRAM, RULE_DECLARATION_LIST, RULE_DECLARATION, RULE_VAR_DECLARATION,
+    RULE_TYPE_SPECIFIER, RULE_FUN_DECLARATION, RULE_PARAMS, RULE_PARAM_LIST,
+    RULE_PARAM, RULE_COMPOUND_STMT, RULE_LOCAL_DECLARATIONS, RULE_STMT_LIST,
+    RULE_STMT, RULE_EXPRESSION_STMT, RULE_SELECTION_STMT, RULE_ITERATION_STMT,
+    RULE_RETURN_STMT, RULE_EXPR, RULE_VAR, RULE_SIMPLE_EXPR, RULE_RELOP,
+    RULE_ADDITIVE_EXPR, RULE_ADDOP, RULE_TERM, RULE_MULOP, RULE_FACTOR,
+    RULE_CALL, RULE_ARGS, RULE_ARG_LIST,
+    RULE_COUNT
+};
+
+// The names diagnostics and the profiler print for each rule
+constexpr const char* const RULE_NAMES[RULE_COUNT] = {
+    "(none)",
+    "program", "declarationList", "declaration", "varDeclaration",
+    "typeSpecifier", "funDeclaration", "params", "paramList",
+    "param", "compoundStmt", "localDeclarations", "stmtList",
+    "stmt", "expressionStmt", "selectionStmt", "iterationStmt",
+    "returnStmt", "expr", "var", "simpleExpr", "relop",
+    "additiveExpr", "addop", "term", "mulop", "factor",
+    "call", "args", "argList"
+};
+
+// Thrown by Parser::error. index is the offending token in m_tokens.
+// function points at a string literal or a static name table, so
+// throwing one allocates nothing beyond the exception itself. When the
+// parser gives up for a reason other than a token, such as nesting too
+// deep for the stack, expected is ERROR and function is the reason.
+struct ParseError
+{
+    ParseError (const char* pFunction, TokenType pExpected, int pIndex)
+        : function (pFunction), expected (pExpected), index (pIndex)
+    { }
+
+    const char* function;
+    TokenType   expected;
+    int         index;
+};
+
+// The three-line diagnostic CMinus prints for e
+std::string
+describe (const std::vector<Token>& tokens, const ParseError& e);
+
 class Parser
 {
     public :
         Parser (std::vector<Token> tokenVector);
 
+        // Parses tokens as a lexer on another thread produces them
+        Parser (TokenQueue& queue);
+
         ~Parser ();
 
         void
-        match (const std::string& function, TokenType expectedType);
+        match (ParserRule rule, TokenType expectedType);
 
         void
-        error (const std::string& function, TokenType expectedType);
+        error (ParserRule rule, TokenType expectedType);
+
+        // The diagnostic start () prints for e
+        std::string
+        describe (const ParseError& e);
+
+        // Parses the whole input and returns the diagnostic start ()
+        // would print for it, or "" if the program is valid
+        std::string
+        check ();
+
+        // As check (), and builds the syntax tree of a valid program into
+        // ast; ast is left empty when the program is invalid
+        std::string
+        parse (Ast& ast);
 
         void
         start();
@@ -117,9 +183,34 @@ class Parser
         void
         argList();
 
+    private:
+        void
+        spill (void (Parser::*rule) ());
+
+        void
+        fill ();
+
+        TokenType
+        lookahead (int k);
+
     public:
         std::vector<Token> m_tokens;
         int m_index;
+
+    private:
+        // Current stmt/expr nesting, and the nesting at which the next
+        // call continues on a new stack segment
+        int m_depth;
+        int m_depthLimit;
+
+        // Streaming input: match refills m_tokens from the queue once
+        // m_index reaches m_fillMark, keeping the parser's two tokens of
+        // lookahead available. INT_MAX once END_OF_FILE has arrived.
+        TokenQueue* m_queue;
+        int m_fillMark;
+
+        // Tree being built by parse (), NULL for check ()
+        Ast* m_ast;
 };
 
 #endif
\ No newline at end of file
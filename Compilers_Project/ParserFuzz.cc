@@ -0,0 +1,508 @@
+/*
+    Filename    : ParserFuzz.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parser Fuzzing
+*/
+
+/***********************/
+// System includes
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/***********************/
+// Local includes
+
+#include "Ast.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+/***********************/
+
+// Feeds arbitrary bytes through Lexer and Parser, and checks that the
+// syntax tree of every valid program has the shape its consumers rely on
+// (an AST_WHILE has a condition and a statement, and so on). Built with
+// -DCMINUS_LIBFUZZER this is only the libFuzzer entry point; otherwise it
+// is also a standalone driver that mutates seed programs deterministically
+// and keeps two kinds of findings in the output directory:
+//   crash-N.cm   an input that threw (crash.cm if it killed the process)
+//   slow-N.cm    an input whose lex and parse took more than --slow-ns
+//                nanoseconds per byte, counting 256 bytes of fixed cost
+//                so tiny inputs do not dominate
+// The same seed and seed files give the same inputs in the same order;
+// which of them count as slow depends on the machine.
+//   usage: ParserFuzz [--runs=N] [--seed=N] [--max-len=N] [--slow-ns=N]
+//                     [--out=DIR] seed.cm...
+
+/***********************/
+
+static bool
+isStmt (uint8_t kind)
+{
+    return kind == AST_COMPOUND || kind == AST_EXPR_STMT || kind == AST_IF || kind == AST_WHILE ||
+           kind == AST_RETURN || kind == AST_EMPTY;
+}
+
+static bool
+isExpr (uint8_t kind)
+{
+    return kind == AST_ASSIGN || kind == AST_BINARY || kind == AST_VAR || kind == AST_SUBSCRIPT ||
+           kind == AST_CALL || kind == AST_NUM || kind == AST_EMPTY;
+}
+
+// Throws if some node's children are not what its kind promises
+static void
+checkShape (const Ast& ast)
+{
+    const std::vector<AstNode>& nodes = ast.nodes ();
+    if (nodes.empty () || nodes[0].kind != AST_PROGRAM)
+    {
+        throw std::logic_error ("syntax tree has no program node");
+    }
+    for (uint32_t id = 0; id < nodes.size (); ++id)
+    {
+        const AstNode& n = nodes[id];
+        if (n.firstChild + (uint64_t) n.childCount > ast.children ().size ())
+        {
+            throw std::logic_error ("syntax tree child list out of range");
+        }
+        bool ok = true;
+        for (uint32_t k = 0; k < n.childCount && ok; ++k)
+        {
+            uint32_t c = ast.child (id, k);
+            uint8_t kind = c < nodes.size () ? nodes[c].kind : AST_KIND_COUNT;
+            bool last = k + 1 == n.childCount;
+            switch (n.kind)
+            {
+                case AST_PROGRAM:
+                    ok = kind == AST_VAR_DECL || kind == AST_ARRAY_DECL || kind == AST_FUN_DECL;
+                    break;
+                case AST_FUN_DECL:
+                    ok = last ? kind == AST_COMPOUND : kind == AST_PARAM || kind == AST_ARRAY_PARAM;
+                    break;
+                case AST_COMPOUND:
+                    ok = kind == AST_VAR_DECL || kind == AST_ARRAY_DECL || isStmt (kind);
+                    break;
+                case AST_IF:
+                case AST_WHILE:
+                    ok = k == 0 ? isExpr (kind) : isStmt (kind);
+                    break;
+                case AST_ASSIGN:
+                    ok = k == 0 ? kind == AST_VAR || kind == AST_SUBSCRIPT : isExpr (kind);
+                    break;
+                case AST_EXPR_STMT:
+                case AST_RETURN:
+                case AST_BINARY:
+                case AST_SUBSCRIPT:
+                case AST_CALL:
+                    ok = isExpr (kind);
+                    break;
+                default:
+                    ok = false;
+                    break;
+            }
+        }
+        uint32_t count = n.childCount;
+        switch (n.kind)
+        {
+            case AST_FUN_DECL:   ok = ok && count >= 1; break;
+            case AST_IF:         ok = ok && (count == 2 || count == 3); break;
+            case AST_WHILE:
+            case AST_ASSIGN:
+            case AST_BINARY:     ok = ok && count == 2; break;
+            case AST_EXPR_STMT:
+            case AST_RETURN:     ok = ok && count <= 1; break;
+            case AST_SUBSCRIPT:  ok = ok && count == 1; break;
+            default:             break;
+        }
+        if (!ok)
+        {
+            throw std::logic_error (std::string ("malformed ") + AST_KIND_NAMES[n.kind] + " in syntax tree");
+        }
+    }
+}
+
+// True if the input is a valid program
+static bool
+fuzzOne (const uint8_t* data, size_t size)
+{
+    Lexer lex ((const char*) data, size);
+    Parser pars (lex.tokenize ());
+    Ast ast;
+    if (!pars.parse (ast).empty ())
+    {
+        return false;
+    }
+    checkShape (ast);
+    return true;
+}
+
+extern "C" int
+LLVMFuzzerTestOneInput (const uint8_t* data, size_t size)
+{
+    fuzzOne (data, size);
+    return 0;
+}
+
+/***********************/
+
+#ifndef CMINUS_LIBFUZZER
+
+namespace
+{
+    // xorshift64*, so runs repeat exactly for a seed
+    class Random
+    {
+    public:
+        Random (uint64_t seed)
+            : m_state (seed * 0x9E3779B97F4A7C15ull + 1)
+        {
+        }
+
+        uint64_t
+        next ()
+        {
+            m_state ^= m_state >> 12;
+            m_state ^= m_state << 25;
+            m_state ^= m_state >> 27;
+            return m_state * 0x2545F4914F6CDD1Dull;
+        }
+
+        // In [0, n)
+        size_t
+        below (size_t n)
+        {
+            return n == 0 ? 0 : next () % n;
+        }
+
+    private:
+        uint64_t m_state;
+    };
+
+    // Fragments worth splicing in: every token, plus the edges of what the
+    // lexer treats specially
+    const char* const DICTIONARY[] = {
+        "if", "else", "int", "void", "return", "while", "+", "-", "*", "/",
+        "<", "<=", ">", ">=", "==", "!=", "=", ";", ",", "(", ")", "[", "]",
+        "{", "}", "x", "f", "0", "1", "2147483647", "2147483648", "99999999999",
+        "/*", "*/", "!", "\n", "\xFF", "int x;", "x = ", "f (", "a[", "{ }"
+    };
+    const size_t DICTIONARY_SIZE = sizeof (DICTIONARY) / sizeof (DICTIONARY[0]);
+
+    // Where a fatal signal leaves the input that caused it
+    char g_crashPath[4096];
+    const uint8_t* g_input = NULL;
+    size_t g_inputSize = 0;
+
+    void
+    onFatalSignal (int sig)
+    {
+        int fd = open (g_crashPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0)
+        {
+            ssize_t written = write (fd, g_input, g_inputSize);
+            (void) written;
+            close (fd);
+        }
+        signal (sig, SIG_DFL);
+        raise (sig);
+    }
+
+    std::string
+    readFile (const char* path)
+    {
+        std::string text;
+        FILE* f = fopen (path, "rb");
+        if (f == NULL)
+        {
+            perror (path);
+            exit (EXIT_FAILURE);
+        }
+        char buffer[1 << 16];
+        size_t n;
+        while ((n = fread (buffer, 1, sizeof (buffer), f)) > 0)
+        {
+            text.append (buffer, n);
+        }
+        fclose (f);
+        return text;
+    }
+
+    void
+    writeFile (const std::string& path, const std::string& bytes)
+    {
+        FILE* f = fopen (path.c_str (), "wb");
+        if (f == NULL || fwrite (bytes.data (), 1, bytes.size (), f) != bytes.size ())
+        {
+            perror (path.c_str ());
+        }
+        if (f != NULL)
+        {
+            fclose (f);
+        }
+    }
+
+    // Byte-level edits
+    void
+    mutateBytes (std::string& input, const std::vector<std::string>& seeds, Random& random)
+    {
+        size_t at = random.below (input.size () + 1);
+        size_t length = 1 + random.below (std::min<size_t> (input.size () - std::min (at, input.size ()), 64) + 1);
+        switch (random.below (7))
+        {
+            case 0:
+                if (!input.empty ())
+                {
+                    input[random.below (input.size ())] ^= 1 << random.below (8);
+                }
+                break;
+            case 1:
+                if (!input.empty ())
+                {
+                    input[random.below (input.size ())] = random.below (256);
+                }
+                break;
+            case 2:
+                input.insert (input.begin () + at, (char) random.below (256));
+                break;
+            case 3:
+                input.erase (std::min (at, input.size ()), length);
+                break;
+            case 4:
+                if (at < input.size ())
+                {
+                    input.insert (at, input.substr (at, length));
+                }
+                break;
+            case 5:
+                input.insert (at, DICTIONARY[random.below (DICTIONARY_SIZE)]);
+                break;
+            default:
+            {
+                const std::string& other = seeds[random.below (seeds.size ())];
+                input = input.substr (0, at) + other.substr (random.below (other.size () + 1));
+                break;
+            }
+        }
+    }
+
+    // Token-level edits: the input is lexed, edited as a token list and
+    // written back out with spaces between tokens. Repeating a range many
+    // times is what builds deep nesting and long operator chains.
+    void
+    mutateTokens (std::string& input, Random& random, size_t maxLength)
+    {
+        Lexer lex (input.data (), input.size ());
+        std::vector<Token> tokens = lex.tokenize ();
+        tokens.pop_back ();
+        std::vector<std::string> lexemes;
+        for (Token& t : tokens)
+        {
+            lexemes.push_back (std::move (t.lexeme));
+        }
+        size_t at = random.below (lexemes.size () + 1);
+        size_t length = std::min (1 + random.below (8), lexemes.size () - std::min (at, lexemes.size ()));
+        std::vector<std::string> range (lexemes.begin () + std::min (at, lexemes.size ()),
+                                        lexemes.begin () + std::min (at, lexemes.size ()) + length);
+        switch (random.below (5))
+        {
+            case 0:
+                lexemes.erase (lexemes.begin () + at, lexemes.begin () + at + length);
+                break;
+            case 1:
+                lexemes.insert (lexemes.begin () + at, range.begin (), range.end ());
+                break;
+            case 2:
+            {
+                size_t bytes = 1;
+                for (const std::string& l : range)
+                {
+                    bytes += l.size () + 1;
+                }
+                size_t times = std::min<size_t> (1 + random.below (1 << (1 + random.below (14))),
+                                                 maxLength / bytes);
+                std::vector<std::string> repeated;
+                repeated.reserve (times * range.size ());
+                for (size_t i = 0; i < times; ++i)
+                {
+                    repeated.insert (repeated.end (), range.begin (), range.end ());
+                }
+                lexemes.insert (lexemes.begin () + at, repeated.begin (), repeated.end ());
+                break;
+            }
+            case 3:
+                lexemes.insert (lexemes.begin () + at, DICTIONARY[random.below (DICTIONARY_SIZE)]);
+                break;
+            default:
+                if (!lexemes.empty ())
+                {
+                    std::swap (lexemes[random.below (lexemes.size ())],
+                               lexemes[random.below (lexemes.size ())]);
+                }
+                break;
+        }
+        input.clear ();
+        for (const std::string& l : lexemes)
+        {
+            input += l;
+            input += l == ";" || l == "{" || l == "}" ? '\n' : ' ';
+        }
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    unsigned long runs = 20000;
+    uint64_t seed = 1;
+    size_t maxLength = 1 << 16;
+    double slowNs = 2000;
+    std::string out = "fuzz-out";
+    std::vector<std::string> seeds;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg (argv[i]);
+        if (arg.compare (0, 7, "--runs=") == 0)
+        {
+            runs = strtoul (arg.c_str () + 7, NULL, 10);
+        }
+        else if (arg.compare (0, 7, "--seed=") == 0)
+        {
+            seed = strtoull (arg.c_str () + 7, NULL, 10);
+        }
+        else if (arg.compare (0, 10, "--max-len=") == 0)
+        {
+            maxLength = strtoul (arg.c_str () + 10, NULL, 10);
+        }
+        else if (arg.compare (0, 10, "--slow-ns=") == 0)
+        {
+            slowNs = atof (arg.c_str () + 10);
+        }
+        else if (arg.compare (0, 6, "--out=") == 0)
+        {
+            out = arg.substr (6);
+        }
+        else if (arg.compare (0, 2, "--") == 0)
+        {
+            fprintf (stderr, "Unknown option: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            seeds.push_back (readFile (argv[i]));
+        }
+    }
+    if (seeds.empty ())
+    {
+        seeds.push_back ("int x;\nvoid main (void) { x = 1; }\n");
+    }
+    mkdir (out.c_str (), 0755);
+    snprintf (g_crashPath, sizeof (g_crashPath), "%s/crash.cm", out.c_str ());
+
+    // Room to run the handler when the stack itself overflowed
+    static char altStack[1 << 16];
+    stack_t ss;
+    ss.ss_sp = altStack;
+    ss.ss_size = sizeof (altStack);
+    ss.ss_flags = 0;
+    sigaltstack (&ss, NULL);
+    struct sigaction action;
+    memset (&action, 0, sizeof (action));
+    action.sa_handler = onFatalSignal;
+    action.sa_flags = SA_ONSTACK;
+    for (int sig : { SIGSEGV, SIGBUS, SIGABRT, SIGFPE, SIGILL })
+    {
+        sigaction (sig, &action, NULL);
+    }
+
+    Random random (seed);
+    unsigned crashes = 0;
+    unsigned slow = 0;
+    unsigned long valid = 0;
+    double worst = 0;
+    size_t worstSize = 0;
+    double totalSeconds = 0;
+    uint64_t totalBytes = 0;
+    std::vector<std::string> pool (seeds);
+    for (unsigned long run = 0; run < runs; ++run)
+    {
+        // The seeds go first as they are, so a regression input is always
+        // checked
+        std::string input = run < seeds.size () ? seeds[run] : pool[random.below (pool.size ())];
+        for (size_t edits = run < seeds.size () ? 0 : 1 + random.below (4); edits > 0; --edits)
+        {
+            if (random.below (2) == 0)
+            {
+                mutateBytes (input, seeds, random);
+            }
+            else
+            {
+                mutateTokens (input, random, maxLength);
+            }
+        }
+        if (input.size () > maxLength)
+        {
+            input.resize (maxLength);
+        }
+
+        g_input = (const uint8_t*) input.data ();
+        g_inputSize = input.size ();
+        auto begin = std::chrono::steady_clock::now ();
+        try
+        {
+            valid += fuzzOne (g_input, g_inputSize);
+        }
+        catch (const std::exception& e)
+        {
+            writeFile (out + "/crash-" + std::to_string (++crashes) + ".cm", input);
+            fprintf (stderr, "run %lu: exception: %s\n", run, e.what ());
+        }
+        double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - begin).count ();
+        totalSeconds += seconds;
+        totalBytes += input.size ();
+
+        double nsPerByte = seconds * 1e9 / (input.size () + 256);
+        if (nsPerByte > worst)
+        {
+            worst = nsPerByte;
+            worstSize = input.size ();
+        }
+        if (nsPerByte > slowNs)
+        {
+            writeFile (out + "/slow-" + std::to_string (++slow) + ".cm", input);
+            fprintf (stderr, "run %lu: %.0f ns/byte over %zu bytes\n", run, nsPerByte, input.size ());
+        }
+        // Keep some mutants to mutate further, so edits compound; the seeds
+        // themselves are never replaced
+        if (random.below (8) == 0)
+        {
+            if (pool.size () < seeds.size () + 64)
+            {
+                pool.push_back (input);
+            }
+            else
+            {
+                pool[seeds.size () + random.below (pool.size () - seeds.size ())] = input;
+            }
+        }
+    }
+    printf ("fuzz: %lu runs (%lu valid) in %.2fs, %.0f runs/s, %.1f MB/s; %u crashes, %u slow; "
+            "worst %.0f ns/byte over %zu bytes\n",
+            runs, valid, totalSeconds, runs / totalSeconds, totalBytes / totalSeconds / 1e6, crashes,
+            slow, worst, worstSize);
+    return crashes > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+    Filename    : ParserProfile.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parser Profiling
+*/
+
+/***********************/
+// System includes
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+/***********************/
+// Local includes
+
+#include "ParserProfile.h"
+
+/***********************/
+
+thread_local volatile sig_atomic_t ParserProfiler::s_current = RULE_NONE;
+volatile sig_atomic_t ParserProfiler::s_samples[RULE_COUNT];
+
+ParserProfiler g_parserProfiler;
+
+/***********************/
+
+ParserProfiler::Scope::Scope (ParserRule rule)
+{
+    m_saved = (ParserRule) s_current;
+    s_current = rule;
+    ++g_parserProfiler.m_calls[rule];
+}
+
+ParserProfiler::Scope::~Scope ()
+{
+    s_current = m_saved;
+}
+
+/***********************/
+
+ParserProfiler::ParserProfiler ()
+    : m_hz (0), m_reported (false)
+{
+    memset (m_calls, 0, sizeof (m_calls));
+    memset (m_tokens, 0, sizeof (m_tokens));
+    memset (m_rewinds, 0, sizeof (m_rewinds));
+    memset (m_rewoundTokens, 0, sizeof (m_rewoundTokens));
+
+    // CMINUS_PROFILE_HZ=<n> turns on the exclusive-time sampler
+    const char* hz = getenv ("CMINUS_PROFILE_HZ");
+    if (hz != NULL)
+    {
+        startSampling (atoi (hz));
+    }
+}
+
+// start () calls exit (1) on an invalid program, and exit runs static
+// destructors, so printing the report from here covers invalid programs
+// as well as valid ones
+ParserProfiler::~ParserProfiler ()
+{
+    report ();
+}
+
+void
+ParserProfiler::tokenMatched ()
+{
+    ++m_tokens[s_current];
+}
+
+void
+ParserProfiler::rewind (int tokens)
+{
+    ++m_rewinds[s_current];
+    m_rewoundTokens[s_current] += tokens;
+}
+
+void
+ParserProfiler::onSample (int signum)
+{
+    (void) signum;
+    s_samples[s_current] = s_samples[s_current] + 1;
+}
+
+void
+ParserProfiler::startSampling (int hz)
+{
+    if (hz <= 0)
+    {
+        return;
+    }
+    m_hz = hz;
+
+    struct sigaction action;
+    memset (&action, 0, sizeof (action));
+    action.sa_handler = onSample;
+    action.sa_flags = SA_RESTART;
+    sigaction (SIGPROF, &action, NULL);
+
+    // ITIMER_PROF counts the CPU time of every thread, but Linux sends
+    // SIGPROF to the thread whose time ran out, and s_current is per
+    // thread: samples on threads outside the parser, such as the
+    // --pipeline lexer, land in (none) rather than in a rule
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = hz >= 1000000 ? 1 : 1000000 / hz;
+    timer.it_value = timer.it_interval;
+    setitimer (ITIMER_PROF, &timer, NULL);
+}
+
+void
+ParserProfiler::stopSampling ()
+{
+    if (m_hz == 0)
+    {
+        return;
+    }
+    struct itimerval timer;
+    memset (&timer, 0, sizeof (timer));
+    setitimer (ITIMER_PROF, &timer, NULL);
+    signal (SIGPROF, SIG_IGN);
+}
+
+void
+ParserProfiler::report ()
+{
+    if (m_reported)
+    {
+        return;
+    }
+    m_reported = true;
+    stopSampling ();
+
+    long totalSamples = 0;
+    for (int r = 0; r < RULE_COUNT; ++r)
+    {
+        totalSamples += s_samples[r];
+    }
+
+    fprintf (stderr, "\n%-18s %12s %12s %10s %12s", "RULE", "CALLS", "TOKENS",
+             "REWINDS", "REWOUND");
+    if (m_hz > 0)
+    {
+        fprintf (stderr, " %10s %10s %7s", "SAMPLES", "EXCL ms", "EXCL %");
+    }
+    fprintf (stderr, "\n");
+
+    for (int r = 0; r < RULE_COUNT; ++r)
+    {
+        if (m_calls[r] == 0 && s_samples[r] == 0)
+        {
+            continue;
+        }
+        fprintf (stderr, "%-18s %12ld %12ld %10ld %12ld", RULE_NAMES[r],
+                 m_calls[r], m_tokens[r], m_rewinds[r], m_rewoundTokens[r]);
+        if (m_hz > 0)
+        {
+            long samples = s_samples[r];
+            fprintf (stderr, " %10ld %10.1f %6.1f%%", samples,
+                     samples * 1000.0 / m_hz,
+                     totalSamples ? samples * 100.0 / totalSamples : 0.0);
+        }
+        fprintf (stderr, "\n");
+    }
+}
@@ -0,0 +1,84 @@
+/*
+    Filename    : ParserProfile.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parser Profiling
+*/
+
+/***********************/
+
+#ifndef PARSER_PROFILE_H
+#define PARSER_PROFILE_H
+
+/***********************/
+
+#include <csignal>
+
+#include "Parser.h"
+
+/***********************/
+
+// Counters collected by an instrumented (-DPARSER_PROFILE) build.
+// Tokens are charged to the innermost rule that matched them, and
+// samples to the innermost rule running on the sampled thread when
+// SIGPROF fired, so both are exclusive. The report is written to stderr
+// at exit.
+class ParserProfiler
+{
+public:
+    class Scope
+    {
+    public:
+        Scope (ParserRule rule);
+
+        ~Scope ();
+
+    private:
+        ParserRule m_saved;
+    };
+
+    ParserProfiler ();
+
+    ~ParserProfiler ();
+
+    void
+    tokenMatched ();
+
+    void
+    rewind (int tokens);
+
+    // Starts the SIGPROF sampler; hz <= 0 leaves it off
+    void
+    startSampling (int hz);
+
+    void
+    stopSampling ();
+
+    void
+    report ();
+
+private:
+    static void
+    onSample (int signum);
+
+private:
+    long m_calls[RULE_COUNT];
+    long m_tokens[RULE_COUNT];
+    long m_rewinds[RULE_COUNT];
+    long m_rewoundTokens[RULE_COUNT];
+    int m_hz;
+    bool m_reported;
+
+    static thread_local volatile sig_atomic_t s_current;
+    static volatile sig_atomic_t s_samples[RULE_COUNT];
+
+    friend class Scope;
+};
+
+/***********************/
+
+extern ParserProfiler g_parserProfiler;
+
+/***********************/
+
+#endif
@@ -0,0 +1,117 @@
+/*
+    Filename    : PipelineBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Pipelined Parsing
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+/***********************/
+// Local includes
+
+#include "Lexer.h"
+#include "Parser.h"
+#include "TokenQueue.h"
+
+/***********************/
+
+// Compares the tokenize()-then-parse flow in CMinus.cc with lexing on a
+// second thread that streams tokens to the parser through a TokenQueue.
+//   usage: PipelineBench file.cm [repetitions]
+
+/***********************/
+
+static bool
+parsedAll (Parser& pars)
+{
+    pars.program ();
+    return pars.m_tokens[pars.m_index].type == END_OF_FILE;
+}
+
+static double
+runSequential (const char* path)
+{
+    auto begin = std::chrono::steady_clock::now ();
+    Lexer lex (fopen (path, "r"));
+    Parser pars (lex.tokenize ());
+    if (!parsedAll (pars))
+    {
+        fprintf (stderr, "%s did not parse\n", path);
+        exit (1);
+    }
+    auto end = std::chrono::steady_clock::now ();
+    return std::chrono::duration<double> (end - begin).count ();
+}
+
+static double
+runPipelined (const char* path)
+{
+    auto begin = std::chrono::steady_clock::now ();
+    Lexer lex (fopen (path, "r"));
+    TokenQueue queue;
+    std::thread lexThread ([&lex, &queue] { lex.tokenize (queue); });
+    Parser pars (queue);
+    bool ok = parsedAll (pars);
+    lexThread.join ();
+    if (!ok)
+    {
+        fprintf (stderr, "%s did not parse\n", path);
+        exit (1);
+    }
+    auto end = std::chrono::steady_clock::now ();
+    return std::chrono::duration<double> (end - begin).count ();
+}
+
+static void
+report (const char* name, std::vector<double>& times, double mb)
+{
+    std::sort (times.begin (), times.end ());
+    double median = times[times.size () / 2];
+    printf ("%-12s min %8.3fs  median %8.3fs  %8.1f MB/s\n", name,
+            times.front (), median, mb / median);
+}
+
+int
+main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s file.cm [repetitions]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* path = argv[1];
+    int reps = argc > 2 ? std::max (1, atoi (argv[2])) : 5;
+
+    struct stat info;
+    if (stat (path, &info) != 0)
+    {
+        perror (path);
+        return EXIT_FAILURE;
+    }
+    double mb = info.st_size / (1024.0 * 1024.0);
+    printf ("%s: %.1f MB, %d repetitions, %u hardware threads\n", path, mb,
+            reps, std::thread::hardware_concurrency ());
+
+    std::vector<double> sequential;
+    std::vector<double> pipelined;
+    for (int i = 0; i < reps; ++i)
+    {
+        sequential.push_back (runSequential (path));
+        pipelined.push_back (runPipelined (path));
+    }
+    report ("sequential", sequential, mb);
+    report ("pipelined", pipelined, mb);
+
+    printf ("speedup      %.2fx\n", sequential[reps / 2] / pipelined[reps / 2]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,221 @@
+/*
+    Filename    : ScannerBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Lexer Engines
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/***********************/
+// Local includes
+
+#include "FlexScanner.h"
+#include "Lexer.h"
+
+/***********************/
+
+// Compares the lexer engines on one file: tokens per second, and peak
+// resident memory of a process that does nothing but tokenize. Each run
+// is a fresh child process so the memory figures do not mix. Fails if the
+// engines disagree on any token. With --check it only compares tokens,
+// on every file given, and fails if built without flex.
+//   usage: ScannerBench file.cm [repetitions]
+//          ScannerBench --check file.cm...
+
+/***********************/
+
+enum Engine
+{
+    HAND, FLEX
+};
+
+static const char* const ENGINE_NAMES[] = { "hand Lexer", "flex scanner" };
+
+static TokenSource*
+openEngine (Engine engine, const char* path)
+{
+    FILE* srcFile = fopen (path, "r");
+    if (srcFile == NULL)
+    {
+        perror (path);
+        exit (EXIT_FAILURE);
+    }
+#ifdef HAVE_FLEX
+    if (engine == FLEX)
+    {
+        return new FlexScanner (srcFile);
+    }
+#endif
+    return new Lexer (srcFile);
+}
+
+struct Run
+{
+    double seconds;
+    size_t tokens;
+    long maxRssKb;
+};
+
+static Run
+runChild (Engine engine, const char* path)
+{
+    int fds[2];
+    if (pipe (fds) != 0)
+    {
+        perror ("pipe");
+        exit (EXIT_FAILURE);
+    }
+    pid_t pid = fork ();
+    if (pid == 0)
+    {
+        close (fds[0]);
+        auto begin = std::chrono::steady_clock::now ();
+        TokenSource* lex = openEngine (engine, path);
+        std::vector<Token> tokens = lex->tokenize ();
+        auto end = std::chrono::steady_clock::now ();
+        Run run = { std::chrono::duration<double> (end - begin).count (), tokens.size (), 0 };
+        ssize_t written = write (fds[1], &run, sizeof (run));
+        _exit (written == sizeof (run) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    close (fds[1]);
+    Run run;
+    bool ok = read (fds[0], &run, sizeof (run)) == sizeof (run);
+    close (fds[0]);
+    int status;
+    struct rusage usage;
+    if (wait4 (pid, &status, 0, &usage) != pid || !ok || !WIFEXITED (status) ||
+        WEXITSTATUS (status) != EXIT_SUCCESS)
+    {
+        fprintf (stderr, "%s failed on %s\n", ENGINE_NAMES[engine], path);
+        exit (EXIT_FAILURE);
+    }
+    run.maxRssKb = usage.ru_maxrss;
+    return run;
+}
+
+#ifdef HAVE_FLEX
+static bool
+sameTokens (const std::vector<Token>& a, const std::vector<Token>& b)
+{
+    if (a.size () != b.size ())
+    {
+        fprintf (stderr, "token counts differ: %zu vs %zu\n", a.size (), b.size ());
+        return false;
+    }
+    for (size_t i = 0; i < a.size (); ++i)
+    {
+        if (a[i].type != b[i].type || a[i].lexeme != b[i].lexeme ||
+            a[i].number != b[i].number || a[i].line != b[i].line ||
+            a[i].column != b[i].column || a[i].offset != b[i].offset)
+        {
+            fprintf (stderr, "token %zu differs: \"%s\" %d:%d @%d vs \"%s\" %d:%d @%d\n", i,
+                     a[i].lexeme.c_str (), a[i].line, a[i].column, a[i].offset,
+                     b[i].lexeme.c_str (), b[i].line, b[i].column, b[i].offset);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+sameTokens (const char* path)
+{
+    TokenSource* hand = openEngine (HAND, path);
+    TokenSource* flex = openEngine (FLEX, path);
+    bool same = sameTokens (hand->tokenize (), flex->tokenize ());
+    delete hand;
+    delete flex;
+    if (!same)
+    {
+        fprintf (stderr, "in %s\n", path);
+    }
+    return same;
+}
+#endif
+
+static int
+check (int files, char* paths[])
+{
+#ifdef HAVE_FLEX
+    for (int i = 0; i < files; ++i)
+    {
+        if (!sameTokens (paths[i]))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    printf ("check-lexers: %d files, same tokens from both engines\n", files);
+    return EXIT_SUCCESS;
+#else
+    (void) paths;
+    fprintf (stderr, "built without flex; no second engine to check %d files against\n", files);
+    return EXIT_FAILURE;
+#endif
+}
+
+int
+main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf (stderr, "usage: %s file.cm [repetitions]\n"
+                         "       %s --check file.cm...\n", argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (std::string (argv[1]) == "--check")
+    {
+        return check (argc - 2, argv + 2);
+    }
+    const char* path = argv[1];
+    int reps = argc > 2 ? std::max (1, atoi (argv[2])) : 5;
+
+    struct stat info;
+    if (stat (path, &info) != 0)
+    {
+        perror (path);
+        return EXIT_FAILURE;
+    }
+    double mb = info.st_size / (1024.0 * 1024.0);
+    printf ("%s: %.1f MB, %d repetitions\n", path, mb, reps);
+
+    std::vector<Engine> engines = { HAND };
+#ifdef HAVE_FLEX
+    engines.push_back (FLEX);
+    if (!sameTokens (path))
+    {
+        return EXIT_FAILURE;
+    }
+#else
+    printf ("built without flex; timing the hand-written Lexer only\n");
+#endif
+
+    for (Engine engine : engines)
+    {
+        std::vector<Run> runs;
+        for (int i = 0; i < reps; ++i)
+        {
+            runs.push_back (runChild (engine, path));
+        }
+        std::sort (runs.begin (), runs.end (), [] (const Run& a, const Run& b) {
+            return a.seconds < b.seconds;
+        });
+        const Run& median = runs[reps / 2];
+        printf ("%-13s median %7.3fs  %7.1f MB/s  %6.1f Mtokens/s  peak RSS %7.1f MB\n",
+                ENGINE_NAMES[engine], median.seconds, mb / median.seconds,
+                median.tokens / median.seconds / 1e6, median.maxRssKb / 1024.0);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*
+    Filename    : SymbolTable.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Language Server
+*/
+
+/***********************/
+// System includes
+
+#include <string>
+#include <unordered_map>
+
+/***********************/
+// Local includes
+
+#include "SymbolTable.h"
+
+/***********************/
+
+// Each name maps to the declarations of it that are in scope, innermost
+// last, and each open scope lists the names it declared so closing it
+// pops exactly those. Lookups do not depend on how deeply scopes nest.
+typedef std::unordered_map<std::string, std::vector<int>> Visible;
+
+/***********************/
+
+SymbolTable::SymbolTable (const std::vector<Token>& tokens)
+    : m_definitions (tokens.size (), -1)
+{
+    Visible visible;
+    std::vector<std::vector<const std::string*>> scopes (1);
+    std::vector<int> params;
+    int parens = 0;
+    for (size_t i = 0; i < tokens.size (); ++i)
+    {
+        switch (tokens[i].type)
+        {
+            case LPAREN:
+                ++parens;
+                break;
+
+            case RPAREN:
+                parens = parens > 0 ? parens - 1 : 0;
+                break;
+
+            case LBRACE:
+                // A function body also scopes its parameters
+                scopes.push_back (std::vector<const std::string*> ());
+                for (int p : params)
+                {
+                    visible[tokens[p].lexeme].push_back (p);
+                    scopes.back ().push_back (&tokens[p].lexeme);
+                }
+                params.clear ();
+                break;
+
+            case RBRACE:
+                if (scopes.size () > 1)
+                {
+                    for (const std::string* name : scopes.back ())
+                    {
+                        visible[*name].pop_back ();
+                    }
+                    scopes.pop_back ();
+                }
+                break;
+
+            case ID:
+                if (i > 0 && (tokens[i - 1].type == INT || tokens[i - 1].type == VOID))
+                {
+                    m_definitions[i] = i;
+                    if (parens > 0 && scopes.size () == 1)
+                    {
+                        params.push_back (i);
+                        break;
+                    }
+                    visible[tokens[i].lexeme].push_back (i);
+                    scopes.back ().push_back (&tokens[i].lexeme);
+                    if (scopes.size () == 1 && parens == 0)
+                    {
+                        // A new global declaration ends any pending header
+                        params.clear ();
+                    }
+                }
+                else
+                {
+                    Visible::const_iterator found = visible.find (tokens[i].lexeme);
+                    if (found != visible.end () && !found->second.empty ())
+                    {
+                        m_definitions[i] = found->second.back ();
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+SymbolTable::~SymbolTable ()
+{
+}
+
+int
+SymbolTable::definition (int index) const
+{
+    if (index < 0 || index >= (int) m_definitions.size ())
+    {
+        return -1;
+    }
+    return m_definitions[index];
+}
@@ -0,0 +1,44 @@
+/*
+    Filename    : SymbolTable.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Language Server
+*/
+
+/***********************/
+
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+/***********************/
+
+#include <vector>
+
+#include "Lexer.h"
+
+/***********************/
+
+// Resolves every identifier use in a token stream to the token that
+// declares it. An ID right after 'int' or 'void' is a declaration;
+// parameters belong to the block that follows them, and each '{' opens
+// a scope. Works on invalid programs too, so an editor can still jump
+// around while the source does not parse.
+class SymbolTable
+{
+public:
+    SymbolTable (const std::vector<Token>& tokens);
+
+    ~SymbolTable ();
+
+    // Index of the declaring token for the ID at index, or -1 if it is
+    // undeclared or not an ID. A declaration resolves to itself.
+    int
+    definition (int index) const;
+
+private:
+    std::vector<int> m_definitions;
+};
+
+/***********************/
+
+#endif
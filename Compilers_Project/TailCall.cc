@@ -0,0 +1,130 @@
+/*
+    Filename    : TailCall.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Tail Calls
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+/***********************/
+// Local includes
+
+#include "SymbolTable.h"
+#include "TailCall.h"
+
+/***********************/
+
+TailCallAnalysis::TailCallAnalysis (const Ast& ast, const std::vector<Token>& tokens)
+    : m_ast (ast), m_tokens (tokens)
+{
+    const std::vector<AstNode>& nodes = ast.nodes ();
+    if (nodes.empty ())
+    {
+        return;
+    }
+    SymbolTable symbols (tokens);
+
+    // Functions by the token that names them, and which declarations are
+    // arrays local to a function
+    std::unordered_map<int, uint32_t> functions;
+    std::vector<bool> localArray (tokens.size (), false);
+    for (uint32_t id = 0; id < nodes.size (); ++id)
+    {
+        if (nodes[id].kind == AST_FUN_DECL)
+        {
+            functions[nodes[id].token] = id;
+        }
+        else if (nodes[id].kind == AST_ARRAY_DECL)
+        {
+            localArray[nodes[id].token] = true;
+        }
+    }
+    for (uint32_t k = 0; k < nodes[0].childCount; ++k)
+    {
+        const AstNode& global = nodes[ast.child (0, k)];
+        if (global.kind == AST_ARRAY_DECL)
+        {
+            localArray[global.token] = false;
+        }
+    }
+
+    // Preorder puts each function's subtree between it and the next one
+    uint32_t function = 0;
+    for (uint32_t id = 0; id < nodes.size (); ++id)
+    {
+        const AstNode& n = nodes[id];
+        if (n.kind == AST_FUN_DECL)
+        {
+            function = id;
+        }
+        if (n.kind != AST_RETURN || n.childCount == 0 ||
+            nodes[ast.child (id, 0)].kind != AST_CALL)
+        {
+            continue;
+        }
+        uint32_t call = ast.child (id, 0);
+        std::unordered_map<int, uint32_t>::const_iterator callee =
+            functions.find (symbols.definition (nodes[call].token));
+        TailCall t = { call, function,
+                       callee != functions.end () ? callee->second : TailCall::UNDECLARED, true };
+        for (uint32_t a = 0; a < nodes[call].childCount; ++a)
+        {
+            const AstNode& arg = nodes[ast.child (call, a)];
+            int d = arg.kind == AST_VAR ? symbols.definition (arg.token) : -1;
+            if (d >= 0 && localArray[d])
+            {
+                t.reusesFrame = false;
+            }
+        }
+        m_calls.push_back (t);
+    }
+}
+
+TailCallAnalysis::~TailCallAnalysis ()
+{
+}
+
+const std::vector<TailCall>&
+TailCallAnalysis::calls () const
+{
+    return m_calls;
+}
+
+const TailCall*
+TailCallAnalysis::find (uint32_t node) const
+{
+    std::vector<TailCall>::const_iterator found =
+        std::lower_bound (m_calls.begin (), m_calls.end (), node,
+                          [] (const TailCall& c, uint32_t n) { return c.node < n; });
+    return found != m_calls.end () && found->node == node ? &*found : NULL;
+}
+
+std::vector<std::string>
+TailCallAnalysis::report () const
+{
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < m_calls.size (); )
+    {
+        uint32_t function = m_calls[i].function;
+        int total = 0;
+        int self = 0;
+        int kept = 0;
+        for (; i < m_calls.size () && m_calls[i].function == function; ++i, ++total)
+        {
+            self += m_calls[i].callee == function;
+            kept += !m_calls[i].reusesFrame;
+        }
+        char line[256];
+        snprintf (line, sizeof (line),
+                  "tail calls: %s: %d calls, %d self-recursive, %d keep the frame for a local array",
+                  m_tokens[m_ast.nodes ()[function].token].lexeme.c_str (), total, self, kept);
+        lines.push_back (line);
+    }
+    return lines;
+}
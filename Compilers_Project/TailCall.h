@@ -0,0 +1,69 @@
+/*
+    Filename    : TailCall.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Tail Calls
+*/
+
+/***********************/
+
+#ifndef TAIL_CALL_H
+#define TAIL_CALL_H
+
+/***********************/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Ast.h"
+#include "Lexer.h"
+
+/***********************/
+
+struct TailCall
+{
+    static constexpr uint32_t UNDECLARED = UINT32_MAX;
+
+    uint32_t node;          // the AST_CALL
+    uint32_t function;      // the AST_FUN_DECL it returns from
+    uint32_t callee;        // AST_FUN_DECL called, or UNDECLARED
+    bool     reusesFrame;   // the callee may take over the caller's frame
+};
+
+// Finds every 'return f (...);', the calls an execution engine can turn
+// into jumps. Self-recursion (callee == function) becomes a jump back to
+// the top of the function with the parameters reassigned.
+//
+// A tail call cannot reuse the caller's frame when an argument is one of
+// the caller's local arrays: arrays are passed by reference, so the array
+// has to outlive the call. Those calls are still listed, with reusesFrame
+// false.
+class TailCallAnalysis
+{
+public:
+    TailCallAnalysis (const Ast& ast, const std::vector<Token>& tokens);
+
+    ~TailCallAnalysis ();
+
+    // In preorder
+    const std::vector<TailCall>&
+    calls () const;
+
+    // The tail call at node, or NULL if node is not one
+    const TailCall*
+    find (uint32_t node) const;
+
+    // One line per function with tail calls
+    std::vector<std::string>
+    report () const;
+
+private:
+    const Ast& m_ast;
+    const std::vector<Token>& m_tokens;
+    std::vector<TailCall> m_calls;
+};
+
+/***********************/
+
+#endif
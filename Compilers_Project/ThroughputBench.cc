@@ -0,0 +1,191 @@
+/*
+    Filename    : ThroughputBench.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Benchmark Corpus
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/***********************/
+// Local includes
+
+#include "BenchClock.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+/***********************/
+
+// Throughput of each stage on each corpus file: the Lexer alone, the
+// Parser alone on tokens lexed beforehand, and the whole CMinus driver as
+// a separate process (start-up and output included). Every stage runs
+// reps times; the table gives the min, median, mean and standard
+// deviation, and MB/s and tokens/s at the median.
+//   usage: ThroughputBench [--reps=N] [--driver=PATH] file.cm ...
+
+/***********************/
+
+struct Stats
+{
+    double min;
+    double median;
+    double mean;
+    double stddev;
+};
+
+static Stats
+summarize (std::vector<double> times)
+{
+    std::sort (times.begin (), times.end ());
+    Stats stats = { times.front (), times[times.size () / 2], 0, 0 };
+    for (double t : times)
+    {
+        stats.mean += t;
+    }
+    stats.mean /= times.size ();
+    for (double t : times)
+    {
+        stats.stddev += (t - stats.mean) * (t - stats.mean);
+    }
+    stats.stddev = times.size () > 1 ? std::sqrt (stats.stddev / (times.size () - 1)) : 0;
+    return stats;
+}
+
+static void
+report (const char* stage, const std::vector<double>& times, double mb, size_t tokens)
+{
+    Stats stats = summarize (times);
+    printf ("  %-7s min %8.4fs  median %8.4fs  mean %8.4fs +- %7.4fs  %8.1f MB/s  %7.2f Mtokens/s\n",
+            stage, stats.min, stats.median, stats.mean, stats.stddev, mb / stats.median,
+            tokens / stats.median / 1e6);
+}
+
+static std::vector<Token>
+lex (const char* path)
+{
+    FILE* srcFile = fopen (path, "r");
+    if (srcFile == NULL)
+    {
+        perror (path);
+        exit (EXIT_FAILURE);
+    }
+    Lexer lexer (srcFile);
+    return lexer.tokenize ();
+}
+
+// Runs the driver with its output thrown away. Either verdict is fine:
+// the invalid corpora are meant to be rejected.
+static double
+runDriver (const char* driver, const char* path)
+{
+    auto begin = std::chrono::steady_clock::now ();
+    pid_t pid = fork ();
+    if (pid == 0)
+    {
+        int null = open ("/dev/null", O_WRONLY);
+        dup2 (null, STDOUT_FILENO);
+        execl (driver, driver, path, (char*) NULL);
+        perror (driver);
+        _exit (127);
+    }
+    int status;
+    if (pid < 0 || waitpid (pid, &status, 0) != pid || !WIFEXITED (status) ||
+        WEXITSTATUS (status) > 1)
+    {
+        fprintf (stderr, "%s failed on %s\n", driver, path);
+        exit (EXIT_FAILURE);
+    }
+    return seconds (begin);
+}
+
+static void
+bench (const char* path, int reps, const char* driver)
+{
+    struct stat info;
+    if (stat (path, &info) != 0)
+    {
+        perror (path);
+        exit (EXIT_FAILURE);
+    }
+    double mb = info.st_size / (1024.0 * 1024.0);
+    std::vector<Token> tokens = lex (path);
+    Parser probe (tokens);
+    bool valid = probe.check ().empty ();
+    printf ("%s: %.2f MB, %zu tokens, %s\n", path, mb, tokens.size (),
+            valid ? "valid" : "invalid");
+
+    std::vector<double> lexTimes;
+    std::vector<double> parseTimes;
+    std::vector<double> driverTimes;
+    for (int i = 0; i < reps; ++i)
+    {
+        auto begin = std::chrono::steady_clock::now ();
+        std::vector<Token> lexed = lex (path);
+        lexTimes.push_back (seconds (begin));
+
+        Parser pars (std::move (lexed));
+        begin = std::chrono::steady_clock::now ();
+        pars.check ();
+        parseTimes.push_back (seconds (begin));
+
+        if (driver != NULL)
+        {
+            driverTimes.push_back (runDriver (driver, path));
+        }
+    }
+    report ("lex", lexTimes, mb, tokens.size ());
+    report ("parse", parseTimes, mb, tokens.size ());
+    if (driver != NULL)
+    {
+        report ("driver", driverTimes, mb, tokens.size ());
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    int reps = 5;
+    const char* driver = NULL;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strncmp (argv[i], "--reps=", 7) == 0)
+        {
+            reps = std::max (atoi (argv[i] + 7), 1);
+        }
+        else if (strncmp (argv[i], "--driver=", 9) == 0)
+        {
+            driver = argv[i] + 9;
+        }
+        else
+        {
+            paths.push_back (argv[i]);
+        }
+    }
+    if (paths.empty ())
+    {
+        fprintf (stderr, "usage: %s [--reps=N] [--driver=PATH] file.cm ...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf ("%d repetitions%s\n", reps, driver == NULL ? ", no driver" : "");
+    for (const char* path : paths)
+    {
+        bench (path, reps, driver);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,53 @@
+/*
+    Filename    : TokenQueue.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Pipelined Parsing
+*/
+
+/***********************/
+// System includes
+
+#include <thread>
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "TokenQueue.h"
+
+/***********************/
+
+TokenQueue::TokenQueue ()
+    : m_head (0), m_tail (0)
+{
+}
+
+TokenQueue::~TokenQueue ()
+{
+}
+
+void
+TokenQueue::push (std::vector<Token>&& chunk)
+{
+    size_t tail = m_tail.load (std::memory_order_relaxed);
+    while (tail - m_head.load (std::memory_order_acquire) == CAPACITY)
+    {
+        std::this_thread::yield ();
+    }
+    m_slots[tail % CAPACITY] = std::move (chunk);
+    m_tail.store (tail + 1, std::memory_order_release);
+}
+
+std::vector<Token>
+TokenQueue::pop ()
+{
+    size_t head = m_head.load (std::memory_order_relaxed);
+    while (head == m_tail.load (std::memory_order_acquire))
+    {
+        std::this_thread::yield ();
+    }
+    std::vector<Token> chunk = std::move (m_slots[head % CAPACITY]);
+    m_head.store (head + 1, std::memory_order_release);
+    return chunk;
+}
@@ -0,0 +1,56 @@
+/*
+    Filename    : TokenQueue.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Pipelined Parsing
+*/
+
+/***********************/
+
+#ifndef TOKEN_QUEUE_H
+#define TOKEN_QUEUE_H
+
+/***********************/
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "Lexer.h"
+
+/***********************/
+
+// Lock-free single-producer/single-consumer ring that hands tokens from a
+// lexer thread to a parser thread. Tokens travel in chunks so the two
+// threads only touch the shared indices once per CHUNK_TOKENS tokens.
+// The chunk holding END_OF_FILE is the last one pushed.
+class TokenQueue
+{
+public:
+    static const size_t CHUNK_TOKENS = 4096;
+
+    TokenQueue ();
+
+    ~TokenQueue ();
+
+    // Producer side; spins while the ring is full
+    void
+    push (std::vector<Token>&& chunk);
+
+    // Consumer side; spins while the ring is empty
+    std::vector<Token>
+    pop ();
+
+private:
+    static const size_t CAPACITY = 64;
+
+    std::vector<Token> m_slots[CAPACITY];
+
+    // Next slot to pop and next slot to push, kept on separate cache lines
+    alignas (64) std::atomic<size_t> m_head;
+    alignas (64) std::atomic<size_t> m_tail;
+};
+
+/***********************/
+
+#endif
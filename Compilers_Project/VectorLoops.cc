@@ -0,0 +1,310 @@
+/*
+    Filename    : VectorLoops.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Vectorizable Loops
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+/***********************/
+// Local includes
+
+#include "SymbolTable.h"
+#include "VectorLoops.h"
+
+/***********************/
+
+namespace
+{
+    class Matcher
+    {
+    public:
+        Matcher (const Ast& ast, const SymbolTable& symbols)
+            : m_ast (ast), m_symbols (symbols)
+        {
+        }
+
+        // True if the AST_WHILE at id has the shape VectorLoopAnalysis
+        // looks for; fills in iv and the statement counts
+        bool
+        match (uint32_t id, VectorLoop& loop)
+        {
+            uint32_t cond = child (id, 0);
+            if (node (cond).kind != AST_BINARY)
+            {
+                return false;
+            }
+            uint32_t left = child (cond, 0);
+            uint32_t bound = child (cond, 1);
+            int op = node (cond).op;
+            if (op == GT || op == GTE)
+            {
+                std::swap (left, bound);
+                op = op == GT ? LT : LTE;
+            }
+            if ((op != LT && op != LTE) || node (left).kind != AST_VAR)
+            {
+                return false;
+            }
+            int iv = declaration (node (left).token);
+            std::vector<int> reads;
+            std::vector<int> targets;
+            if (iv < 0 || (node (bound).kind != AST_NUM && node (bound).kind != AST_VAR) ||
+                !elementwise (bound, iv, reads))
+            {
+                return false;
+            }
+
+            uint32_t body = child (id, 1);
+            const AstNode& b = node (body);
+            if (b.kind != AST_COMPOUND || b.childCount < 2)
+            {
+                return false;
+            }
+            loop.iv = iv;
+            loop.reductions = 0;
+            loop.maps = 0;
+            for (uint32_t k = 0; k < b.childCount; ++k)
+            {
+                uint32_t s = child (body, k);
+                if (node (s).kind != AST_EXPR_STMT || node (s).childCount != 1 ||
+                    node (child (s, 0)).kind != AST_ASSIGN)
+                {
+                    return false;
+                }
+                uint32_t target = child (child (s, 0), 0);
+                uint32_t value = child (child (s, 0), 1);
+                bool last = k + 1 == b.childCount;
+                if (last)
+                {
+                    if (node (target).kind != AST_VAR || declaration (node (target).token) != iv ||
+                        !increments (value, iv))
+                    {
+                        return false;
+                    }
+                }
+                else if (node (target).kind == AST_SUBSCRIPT)
+                {
+                    if (!indexedBy (target, iv) || !elementwise (value, iv, reads))
+                    {
+                        return false;
+                    }
+                    ++loop.maps;
+                }
+                else if (node (target).kind == AST_VAR)
+                {
+                    int d = declaration (node (target).token);
+                    std::vector<int> own;
+                    if (d < 0 || d == iv ||
+                        std::find (targets.begin (), targets.end (), d) != targets.end () ||
+                        !reduction (value, d, iv, own) ||
+                        std::find (own.begin (), own.end (), d) != own.end ())
+                    {
+                        return false;
+                    }
+                    targets.push_back (d);
+                    reads.insert (reads.end (), own.begin (), own.end ());
+                    ++loop.reductions;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            for (int r : reads)
+            {
+                if (std::find (targets.begin (), targets.end (), r) != targets.end ())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        const AstNode&
+        node (uint32_t id)
+        {
+            return m_ast.nodes ()[id];
+        }
+
+        uint32_t
+        child (uint32_t id, uint32_t k)
+        {
+            return m_ast.child (id, k);
+        }
+
+        int
+        declaration (uint32_t token)
+        {
+            return m_symbols.definition (token);
+        }
+
+        // 'iv + 1' or '1 + iv'
+        bool
+        increments (uint32_t id, int iv)
+        {
+            const AstNode& n = node (id);
+            if (n.kind != AST_BINARY || n.op != PLUS)
+            {
+                return false;
+            }
+            const AstNode& a = node (child (id, 0));
+            const AstNode& b = node (child (id, 1));
+            return (a.kind == AST_VAR && declaration (a.token) == iv && b.kind == AST_NUM && b.value == 1) ||
+                   (b.kind == AST_VAR && declaration (b.token) == iv && a.kind == AST_NUM && a.value == 1);
+        }
+
+        // A subscript whose index is exactly iv
+        bool
+        indexedBy (uint32_t id, int iv)
+        {
+            const AstNode& index = node (child (id, 0));
+            return index.kind == AST_VAR && declaration (index.token) == iv;
+        }
+
+        // 's + e', 's - e', 's * e', 'e + s' or 'e * s' with e elementwise
+        bool
+        reduction (uint32_t id, int s, int iv, std::vector<int>& reads)
+        {
+            const AstNode& n = node (id);
+            if (n.kind != AST_BINARY || (n.op != PLUS && n.op != MINUS && n.op != TIMES))
+            {
+                return false;
+            }
+            const AstNode& a = node (child (id, 0));
+            const AstNode& b = node (child (id, 1));
+            if (a.kind == AST_VAR && declaration (a.token) == s)
+            {
+                return elementwise (child (id, 1), iv, reads);
+            }
+            if (n.op != MINUS && b.kind == AST_VAR && declaration (b.token) == s)
+            {
+                return elementwise (child (id, 0), iv, reads);
+            }
+            return false;
+        }
+
+        // Numbers, variables, subscripts by iv, and +, - and * of those.
+        // Appends the variables read to reads. Scans the subtree in
+        // preorder rather than recursing, so a long operator chain costs
+        // no C++ stack; pending counts the subtrees still to scan.
+        bool
+        elementwise (uint32_t id, int iv, std::vector<int>& reads)
+        {
+            uint32_t pending = 1;
+            for (uint32_t next = id; pending > 0; ++next)
+            {
+                const AstNode& n = node (next);
+                --pending;
+                switch (n.kind)
+                {
+                    case AST_NUM:
+                        break;
+
+                    case AST_VAR:
+                    {
+                        int d = declaration (n.token);
+                        reads.push_back (d);
+                        if (d < 0)
+                        {
+                            return false;
+                        }
+                        break;
+                    }
+
+                    case AST_SUBSCRIPT:
+                        if (!indexedBy (next, iv))
+                        {
+                            return false;
+                        }
+                        // Skip the index, iv itself, which is the next node
+                        ++next;
+                        break;
+
+                    case AST_BINARY:
+                        if (n.op != PLUS && n.op != MINUS && n.op != TIMES)
+                        {
+                            return false;
+                        }
+                        pending += 2;
+                        break;
+
+                    default:
+                        return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        const Ast& m_ast;
+        const SymbolTable& m_symbols;
+    };
+}
+
+/***********************/
+
+VectorLoopAnalysis::VectorLoopAnalysis (const Ast& ast, const std::vector<Token>& tokens)
+    : m_ast (ast), m_tokens (tokens)
+{
+    const std::vector<AstNode>& nodes = ast.nodes ();
+    if (nodes.empty ())
+    {
+        return;
+    }
+    SymbolTable symbols (tokens);
+    Matcher matcher (ast, symbols);
+    uint32_t function = 0;
+    for (uint32_t id = 0; id < nodes.size (); ++id)
+    {
+        if (nodes[id].kind == AST_FUN_DECL)
+        {
+            function = id;
+        }
+        VectorLoop loop = { id, function, -1, 0, 0 };
+        if (nodes[id].kind == AST_WHILE && matcher.match (id, loop))
+        {
+            m_loops.push_back (loop);
+        }
+    }
+}
+
+VectorLoopAnalysis::~VectorLoopAnalysis ()
+{
+}
+
+const std::vector<VectorLoop>&
+VectorLoopAnalysis::loops () const
+{
+    return m_loops;
+}
+
+std::vector<std::string>
+VectorLoopAnalysis::report () const
+{
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < m_loops.size (); )
+    {
+        uint32_t function = m_loops[i].function;
+        int loops = 0;
+        unsigned reductions = 0;
+        unsigned maps = 0;
+        for (; i < m_loops.size () && m_loops[i].function == function; ++i, ++loops)
+        {
+            reductions += m_loops[i].reductions;
+            maps += m_loops[i].maps;
+        }
+        char line[256];
+        snprintf (line, sizeof (line), "vector: %s: %d loops, %u reductions, %u maps",
+                  m_tokens[m_ast.nodes ()[function].token].lexeme.c_str (), loops, reductions, maps);
+        lines.push_back (line);
+    }
+    return lines;
+}
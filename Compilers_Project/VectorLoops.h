@@ -0,0 +1,76 @@
+/*
+    Filename    : VectorLoops.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Vectorizable Loops
+*/
+
+/***********************/
+
+#ifndef VECTOR_LOOPS_H
+#define VECTOR_LOOPS_H
+
+/***********************/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Ast.h"
+#include "Lexer.h"
+
+/***********************/
+
+// A while loop whose iterations a back end can run several at a time
+struct VectorLoop
+{
+    uint32_t node;          // the AST_WHILE
+    uint32_t function;      // its AST_FUN_DECL
+    int      iv;            // declaring token of the induction variable
+    uint32_t reductions;    // statements 's = s + e', 's = s - e', 's = s * e'
+    uint32_t maps;          // statements 'b[i] = e'
+};
+
+// Finds loops of the form
+//
+//   while (i < n)           (or i <= n, n > i, n >= i)
+//   {
+//       s = s + a[i] * c;   (reductions)
+//       b[i] = a[i] + k;    (maps)
+//       i = i + 1;
+//   }
+//
+// The body has no declarations, calls or nested statements, and ends by
+// adding 1 to i. Every other statement is a reduction or a map. Inside
+// e, subscripts index with exactly i, and every other variable keeps its
+// value for the whole loop: nothing in the loop assigns it, except for a
+// reduction variable, which only its own statement reads. e uses only
+// +, - and *. C-Minus has no pointers, so two arrays are either the same
+// array or do not overlap. Since every access uses index i, no iteration
+// reads an element another iteration writes.
+//
+// Division is left out on purpose: SSE2 and AVX2 have no integer divide.
+class VectorLoopAnalysis
+{
+public:
+    VectorLoopAnalysis (const Ast& ast, const std::vector<Token>& tokens);
+
+    ~VectorLoopAnalysis ();
+
+    // In preorder
+    const std::vector<VectorLoop>&
+    loops () const;
+
+    // One line per function with vectorizable loops
+    std::vector<std::string>
+    report () const;
+
+private:
+    const Ast& m_ast;
+    const std::vector<Token>& m_tokens;
+    std::vector<VectorLoop> m_loops;
+};
+
+/***********************/
+
+#endif
@@ -0,0 +1,155 @@
+/*
+    Filename    : WorkStealingPool.cc
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parallel Middle End
+*/
+
+/***********************/
+// System includes
+
+#include <algorithm>
+
+/***********************/
+// Local includes
+
+#include "WorkStealingPool.h"
+
+/***********************/
+
+WorkStealingPool::WorkStealingPool (unsigned threads)
+    : m_batch (0), m_stop (false), m_task (NULL), m_pending (0), m_steals (0)
+{
+    if (threads == 0)
+    {
+        threads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        m_workers.emplace_back (new Worker);
+    }
+    // Worker 0 is whichever thread calls run ()
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        m_threads.emplace_back (&WorkStealingPool::loop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool ()
+{
+    {
+        std::lock_guard<std::mutex> guard (m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all ();
+    for (std::thread& t : m_threads)
+    {
+        t.join ();
+    }
+}
+
+unsigned
+WorkStealingPool::threads () const
+{
+    return m_workers.size ();
+}
+
+void
+WorkStealingPool::run (size_t count, const std::function<void (size_t)>& task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    m_task = &task;
+    m_pending.store (count);
+    size_t n = m_workers.size ();
+    for (size_t w = 0; w < n; ++w)
+    {
+        std::lock_guard<std::mutex> guard (m_workers[w]->lock);
+        for (size_t i = count * w / n; i < count * (w + 1) / n; ++i)
+        {
+            m_workers[w]->tasks.push_back (i);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard (m_mutex);
+        ++m_batch;
+    }
+    m_wake.notify_all ();
+
+    work (0);
+    std::unique_lock<std::mutex> guard (m_mutex);
+    m_done.wait (guard, [this] { return m_pending.load () == 0; });
+    m_task = NULL;
+}
+
+uint64_t
+WorkStealingPool::steals () const
+{
+    return m_steals.load ();
+}
+
+void
+WorkStealingPool::loop (unsigned self)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard (m_mutex);
+            m_wake.wait (guard, [this, seen] { return m_stop || m_batch != seen; });
+            if (m_stop)
+            {
+                return;
+            }
+            seen = m_batch;
+        }
+        work (self);
+    }
+}
+
+// Runs tasks until every queue is empty. Tasks never add tasks, so once
+// that happens the only work left is what other threads already took.
+void
+WorkStealingPool::work (unsigned self)
+{
+    size_t task;
+    while (take (self, task))
+    {
+        (*m_task) (task);
+        if (m_pending.fetch_sub (1) == 1)
+        {
+            std::lock_guard<std::mutex> guard (m_mutex);
+            m_done.notify_all ();
+        }
+    }
+}
+
+bool
+WorkStealingPool::take (unsigned self, size_t& task)
+{
+    {
+        Worker& own = *m_workers[self];
+        std::lock_guard<std::mutex> guard (own.lock);
+        if (!own.tasks.empty ())
+        {
+            task = own.tasks.front ();
+            own.tasks.pop_front ();
+            return true;
+        }
+    }
+    for (size_t k = 1; k < m_workers.size (); ++k)
+    {
+        Worker& victim = *m_workers[(self + k) % m_workers.size ()];
+        std::lock_guard<std::mutex> guard (victim.lock);
+        if (!victim.tasks.empty ())
+        {
+            task = victim.tasks.back ();
+            victim.tasks.pop_back ();
+            m_steals.fetch_add (1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,90 @@
+/*
+    Filename    : WorkStealingPool.h
+    Author      : Evan Hanzelman
+    Course      : CSCI 435
+    Assignment  : CMinus Parallel Middle End
+*/
+
+/***********************/
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+/***********************/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************/
+
+// Fixed set of threads that run batches of independent tasks. A batch is
+// split into one contiguous run of task numbers per thread; each thread
+// works through its own run from the front, and a thread that runs out
+// steals from the back of another's, so a few expensive tasks do not
+// leave the other threads idle. The thread calling run () is one of the
+// workers.
+class WorkStealingPool
+{
+public:
+    // threads = 0 uses one per hardware thread
+    WorkStealingPool (unsigned threads = 0);
+
+    ~WorkStealingPool ();
+
+    unsigned
+    threads () const;
+
+    // Calls task (i) once for every i in [0, count) and returns when all
+    // of them have returned. Calls on different threads overlap, so
+    // task (i) should only write state that belongs to i.
+    void
+    run (size_t count, const std::function<void (size_t)>& task);
+
+    // Tasks taken from another thread's run, over all batches
+    uint64_t
+    steals () const;
+
+private:
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    void
+    loop (unsigned self);
+
+    void
+    work (unsigned self);
+
+    bool
+    take (unsigned self, size_t& task);
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // Guards m_batch and m_stop; workers sleep on m_wake between batches
+    // and run () sleeps on m_done until m_pending reaches 0
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_batch;
+    bool m_stop;
+
+    const std::function<void (size_t)>* m_task;
+    std::atomic<size_t> m_pending;
+    std::atomic<uint64_t> m_steals;
+};
+
+/***********************/
+
+#endif